@@ -0,0 +1,346 @@
+/*
+ * This file contains the entry point of the headless analysis tool.
+ *
+ * It runs the same pipeline as the Extract Metrics button of the plugin, without GUI or audio
+ * device: every input file is loaded, compressed with the peak and RMS compressor, analyzed by
+ * Metrics and exported by DataExport (metrics report and optionally the compressed WAVs).
+ *
+ * Parameters come from a preset of Preset::AllPresets and/or explicit values; explicit values
+ * override the preset. Without either, the plugin's default parameter values are used.
+ *
+ * Usage:
+ *   PeakRMSCompressorAnalyzer --output <dir> [options] <file or folder>...
+ *     --preset <name|id>            preset of Presets.h (--list-presets prints them)
+ *     --peak t,r,a,rel,knee,makeup  peak threshold (dB), ratio, attack (ms), release (ms), knee (dB), makeup (dB)
+ *     --rms  t,r,a,rel,knee,makeup  same for the RMS compressor
+ *     --lookahead <ms>              lookahead of both compressors
+ *     --save-wavs                   also export the compressed files
+ *     --parallel [--segments N] [--verify]   segment-parallel compression
+ *     --control-rate <N>            compare with the gain evaluated every N samples (4, 8, 16, 32)
+ *     --chunk-size <N>              offline block size (default 1024)
+ *     --streaming                   fixed-memory chunk by chunk analysis, no length limit
+ *     --pipelined [--pipeline-depth N]   streaming with decode, compression, metrics and writing
+ *                                   on their own threads (N chunks in flight, default 4)
+ *     --cache <dir> [--cache-size MB]   keep decoded MP3s in dir for later runs (default cap 4096 MB)
+ *     --window <ms> --hop <ms>      windows of the short-term metrics (default 400 ms every 200 ms)
+ *     --metrics-threads <N>         threads of the metrics computation (default one per core, 1 => serial)
+ *     --exact-percentiles           LRA and transient impact from sorted values instead of histograms
+ *
+ * Folders are scanned (not recursively) for .wav and .mp3 files.
+ * Exit code: 0 if every file was analyzed, 1 if any file failed, 2 for invalid arguments.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <JuceHeader.h>
+#include <map>
+#include <string>
+#include "../../Source/dsp/include/Compressor.h"
+#include "../../Source/metrics/include/AudioFileLoader.h"
+#include "../../Source/metrics/include/DataExport.h"
+#include "../../Source/metrics/include/Metrics.h"
+#include "../../Source/metrics/include/MetricsExtractionEngine.h"
+#include "../../Source/util/include/Constants.h"
+#include "../../Source/util/include/Presets.h"
+
+namespace
+{
+    // Parameter ids as in the plugin's AudioProcessorValueTreeState
+    using ParameterValues = std::map<juce::String, float>;
+
+    // Default values of the plugin's parameter layout
+    ParameterValues getDefaultParameters()
+    {
+        return {
+            { "peak_threshold", 0.0f }, { "peak_ratio", 3.0f }, { "peak_attack", 50.0f },
+            { "peak_release", 250.0f }, { "peak_knee", 0.0f }, { "peak_makeup", 0.0f },
+            { "rms_threshold", 0.0f }, { "rms_ratio", 3.0f }, { "rms_attack", 50.0f },
+            { "rms_release", 250.0f }, { "rms_knee", 0.0f }, { "rms_makeup", 0.0f },
+            { "lookahead", 0.0f }
+        };
+    }
+
+    void setParameters(ParameterValues& values, const juce::String& prefix, const Preset::PresetData::Parameters& p)
+    {
+        values[prefix + "threshold"] = p.threshold;
+        values[prefix + "ratio"] = p.ratio;
+        values[prefix + "attack"] = p.attack;
+        values[prefix + "release"] = p.release;
+        values[prefix + "knee"] = p.knee;
+        values[prefix + "makeup"] = p.makeup;
+    }
+
+    const Preset::PresetData* findPreset(const juce::String& nameOrId)
+    {
+        for (const auto& preset : Preset::AllPresets)
+            if (nameOrId.equalsIgnoreCase(preset.name) || (nameOrId.containsOnly("0123456789") && nameOrId.getIntValue() == preset.id))
+                return &preset;
+
+        return nullptr;
+    }
+
+    // "threshold,ratio,attack,release,knee,makeup"
+    bool parseParameterList(const juce::String& text, const juce::String& prefix, ParameterValues& values, juce::String& error)
+    {
+        const auto tokens = juce::StringArray::fromTokens(text, ",", "");
+        if (tokens.size() != 6)
+        {
+            error = "Expected 6 comma separated values for " + prefix + "parameters, got: " + text;
+            return false;
+        }
+
+        using namespace Constants::Parameter;
+        const juce::String names[] = { "threshold", "ratio", "attack", "release", "knee", "makeup" };
+        const juce::Range<float> ranges[] = { { thresholdStart, thresholdEnd }, { ratioStart, ratioEnd },
+            { attackStart, attackEnd }, { releaseStart, releaseEnd }, { kneeStart, kneeEnd }, { makeupStart, makeupEnd } };
+
+        for (int i = 0; i < 6; ++i)
+        {
+            const float value = tokens[i].trim().getFloatValue();
+            if (value < ranges[i].getStart() || value > ranges[i].getEnd())
+            {
+                error = prefix + names[i] + " out of range [" + juce::String(ranges[i].getStart()) + ", "
+                    + juce::String(ranges[i].getEnd()) + "]: " + tokens[i];
+                return false;
+            }
+            values[prefix + names[i]] = value;
+        }
+        return true;
+    }
+
+    void applyParameters(Compressor& compressor, const juce::String& prefix, const ParameterValues& values)
+    {
+        compressor.setThreshold(values.at(prefix + "threshold"));
+        compressor.setRatio(values.at(prefix + "ratio"));
+        compressor.setAttack(values.at(prefix + "attack"));
+        compressor.setRelease(values.at(prefix + "release"));
+        compressor.setKnee(values.at(prefix + "knee"));
+        compressor.setMakeup(values.at(prefix + "makeup"));
+        compressor.setLookahead(values.at("lookahead"));
+    }
+
+    struct Options
+    {
+        ParameterValues parameters = getDefaultParameters();
+        juce::Array<juce::File> inputFiles;
+        juce::File outputDirectory;
+        bool saveWavs = false;
+        MetricsExtractionEngine::Config engineConfig;
+        juce::File cacheDirectory;          // empty => no decoded audio cache
+        juce::int64 cacheMegabytes = 4096;
+    };
+
+    void printUsage()
+    {
+        std::cout << "PeakRMSCompressorAnalyzer --output <dir> [options] <file or folder>...\n"
+                     "  --preset <name|id>            preset of Presets.h (--list-presets prints them)\n"
+                     "  --peak t,r,a,rel,knee,makeup  peak threshold, ratio, attack, release, knee, makeup\n"
+                     "  --rms  t,r,a,rel,knee,makeup  same for the RMS compressor\n"
+                     "  --lookahead <ms>              lookahead of both compressors\n"
+                     "  --save-wavs                   also export the compressed files\n"
+                     "  --parallel [--segments N] [--verify]   segment-parallel compression\n"
+                     "  --control-rate <N>            compare with the gain evaluated every N samples\n"
+                     "  --chunk-size <N>              offline block size (default 1024)\n"
+                     "  --streaming                   fixed-memory chunk by chunk analysis, no length limit\n"
+                     "  --pipelined [--pipeline-depth N]   streaming with one thread per stage\n"
+                     "  --cache <dir> [--cache-size MB]   keep decoded MP3s in dir for later runs\n"
+                     "  --window <ms> --hop <ms>      windows of the short-term metrics (default 400 / 200)\n"
+                     "  --metrics-threads <N>         threads of the metrics computation (default one per core)\n"
+                     "  --exact-percentiles           LRA and transient impact from sorted values\n";
+    }
+
+    void printPresets()
+    {
+        for (const auto& preset : Preset::AllPresets)
+            std::cout << preset.id << "  " << preset.name << "\n";
+    }
+
+    // Returns false with the reason in error for invalid arguments
+    bool parseArguments(const juce::StringArray& args, Options& options, juce::String& error)
+    {
+        juce::String presetName, peakValues, rmsValues;
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+
+            auto nextValue = [&]() -> juce::String
+                {
+                    if (i + 1 >= args.size())
+                    {
+                        error = "Missing value for " + arg;
+                        return {};
+                    }
+                    return args[++i];
+                };
+
+            if (arg == "--preset")              presetName = nextValue();
+            else if (arg == "--peak")           peakValues = nextValue();
+            else if (arg == "--rms")            rmsValues = nextValue();
+            else if (arg == "--lookahead")      options.parameters["lookahead"] = juce::jlimit(Constants::Parameter::lookaheadStart, Constants::Parameter::lookaheadEnd, nextValue().getFloatValue());
+            else if (arg == "--output")         options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(nextValue());
+            else if (arg == "--save-wavs")      options.saveWavs = true;
+            else if (arg == "--parallel")       options.engineConfig.parallelCompression = true;
+            else if (arg == "--segments")       options.engineConfig.numSegments = juce::jmax(0, nextValue().getIntValue());
+            else if (arg == "--verify")         options.engineConfig.verifyParallelCompression = true;
+            else if (arg == "--control-rate")   options.engineConfig.controlRateComparison = nextValue().getIntValue();
+            else if (arg == "--chunk-size")     options.engineConfig.chunkSize = juce::jmax(1, nextValue().getIntValue());
+            else if (arg == "--streaming")      options.engineConfig.streaming = true;
+            else if (arg == "--pipelined")      options.engineConfig.streaming = options.engineConfig.pipelined = true;
+            else if (arg == "--pipeline-depth") options.engineConfig.pipelineDepth = juce::jmax(1, nextValue().getIntValue());
+            else if (arg == "--cache")          options.cacheDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(nextValue());
+            else if (arg == "--cache-size")     options.cacheMegabytes = juce::jmax<juce::int64>(1, nextValue().getLargeIntValue());
+            else if (arg == "--window")         options.engineConfig.windowSeconds = juce::jmax(1.0f, nextValue().getFloatValue()) * 0.001f;
+            else if (arg == "--hop")            options.engineConfig.hopSeconds = juce::jmax(1.0f, nextValue().getFloatValue()) * 0.001f;
+            else if (arg == "--metrics-threads") options.engineConfig.metricsThreads = juce::jmax(0, nextValue().getIntValue());
+            else if (arg == "--exact-percentiles") options.engineConfig.exactPercentiles = true;
+            else if (arg.startsWith("-"))       error = "Unknown option: " + arg;
+            else
+            {
+                const auto path = juce::File::getCurrentWorkingDirectory().getChildFile(arg);
+                if (path.isDirectory())
+                {
+                    auto files = path.findChildFiles(juce::File::findFiles, false, "*.wav;*.mp3");
+                    files.sort();
+                    options.inputFiles.addArray(files);
+                }
+                else
+                {
+                    options.inputFiles.add(path);
+                }
+            }
+
+            if (error.isNotEmpty())
+                return false;
+        }
+
+        if (presetName.isNotEmpty())
+        {
+            const auto* preset = findPreset(presetName);
+            if (preset == nullptr)
+            {
+                error = "Unknown preset: " + presetName;
+                return false;
+            }
+            setParameters(options.parameters, "peak_", preset->peak);
+            setParameters(options.parameters, "rms_", preset->rms);
+        }
+
+        if (peakValues.isNotEmpty() && !parseParameterList(peakValues, "peak_", options.parameters, error))
+            return false;
+        if (rmsValues.isNotEmpty() && !parseParameterList(rmsValues, "rms_", options.parameters, error))
+            return false;
+
+        if (options.outputDirectory == juce::File())
+            error = "--output is required";
+        else if (options.inputFiles.isEmpty())
+            error = "No input files";
+
+        return error.isEmpty();
+    }
+
+    // Same stages as the plugin's Extract Metrics button, with fresh compressors per file
+    bool analyzeFile(const juce::File& file, const Options& options, juce::AudioFormatManager& formatManager,
+        DataExport& dataExport, DecodedAudioCache* cache, juce::String& error)
+    {
+        AudioFileLoader loader(formatManager);
+        loader.setDecodedAudioCache(cache);
+        Compressor peakCompressor, rmsCompressor;
+        Metrics metrics;
+
+        for (auto* compressor : { &peakCompressor, &rmsCompressor })
+            compressor->prepare({ 44100.0, static_cast<juce::uint32>(options.engineConfig.chunkSize), 2 });
+
+        applyParameters(peakCompressor, "peak_", options.parameters);
+        applyParameters(rmsCompressor, "rms_", options.parameters);
+
+        MetricsExtractionEngine engine(loader, dataExport, peakCompressor, rmsCompressor, metrics,
+            [&options](const juce::String& id)
+            {
+                const auto it = options.parameters.find(id);
+                return it != options.parameters.end() ? it->second : 0.0f;
+            },
+            options.engineConfig);
+
+        return engine.run(file, &error);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::CharPointer_UTF8(argv[i]));
+
+    if (args.contains("--help") || args.contains("-h") || args.isEmpty())
+    {
+        printUsage();
+        return args.isEmpty() ? 2 : 0;
+    }
+
+    if (args.contains("--list-presets"))
+    {
+        printPresets();
+        return 0;
+    }
+
+    Options options;
+    juce::String error;
+    if (!parseArguments(args, options, error))
+    {
+        std::cerr << error << "\n\n";
+        printUsage();
+        return 2;
+    }
+
+    if (!options.outputDirectory.createDirectory())
+    {
+        std::cerr << "Unable to create output directory: " << options.outputDirectory.getFullPathName() << "\n";
+        return 2;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    // Reports go straight into the output directory, no subfolder
+    DataExport dataExport(DataExport::Config{ options.outputDirectory, {}, 24, options.saveWavs });
+
+    std::unique_ptr<DecodedAudioCache> cache;
+    if (options.cacheDirectory != juce::File())
+        cache = std::make_unique<DecodedAudioCache>(DecodedAudioCache::Config{ options.cacheDirectory, options.cacheMegabytes << 20 });
+
+    int numFailed = 0;
+    for (const auto& file : options.inputFiles)
+    {
+        std::cout << "Analyzing " << file.getFullPathName() << " ... " << std::flush;
+
+        if (analyzeFile(file, options, formatManager, dataExport, cache.get(), error))
+        {
+            std::cout << "done\n";
+        }
+        else
+        {
+            std::cout << "failed: " << error << "\n";
+            ++numFailed;
+        }
+    }
+
+    std::cout << (options.inputFiles.size() - numFailed) << " of " << options.inputFiles.size()
+              << " files analyzed, results in " << options.outputDirectory.getFullPathName() << "\n";
+
+    return numFailed == 0 ? 0 : 1;
+}
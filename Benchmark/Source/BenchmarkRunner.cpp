@@ -0,0 +1,212 @@
+/*
+ * This file implements BenchmarkRunner, see BenchmarkRunner.h.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkRunner.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define BENCHMARK_HAS_TSC 1
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+BenchmarkRunner::BenchmarkRunner(Options o)
+    : options(std::move(o))
+{
+}
+
+bool BenchmarkRunner::isSelected(const juce::String& kernel) const
+{
+    if (options.filter.isEmpty())
+        return true;
+
+    for (const auto& f : options.filter)
+        if (kernel.containsIgnoreCase(f))
+            return true;
+
+    return false;
+}
+
+int BenchmarkRunner::getBlocksPerRepetition(int blockSize) const
+{
+    return juce::jmax(1, (options.samplesPerRepetition + blockSize - 1) / blockSize);
+}
+
+void BenchmarkRunner::run(const Case& benchmarkCase, const BlockFunction& processBlock)
+{
+    const int numBlocks = getBlocksPerRepetition(benchmarkCase.blockSize);
+
+    results.push_back(measure(benchmarkCase,
+        static_cast<juce::int64>(numBlocks) * benchmarkCase.blockSize,
+        options.warmUpRepetitions,
+        options.repetitions,
+        [&processBlock, numBlocks]()
+        {
+            for (int b = 0; b < numBlocks; ++b)
+                processBlock();
+        }));
+}
+
+void BenchmarkRunner::runSignal(const Case& benchmarkCase, juce::int64 numSamples, int repetitions,
+    const BlockFunction& processSignal)
+{
+    results.push_back(measure(benchmarkCase, numSamples, 1, repetitions, processSignal));
+}
+
+BenchmarkRunner::Result BenchmarkRunner::measure(const Case& benchmarkCase, juce::int64 samplesPerRepetition,
+    int warmUp, int repetitions, const std::function<void()>& repetition) const
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    for (int i = 0; i < warmUp; ++i)
+        repetition();
+
+    std::vector<double> nsPerSample(static_cast<size_t>(repetitions));
+    std::vector<double> cyclesPerSample(static_cast<size_t>(repetitions));
+
+    const double nsPerTick = 1.0e9 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+    const auto samples = static_cast<double>(samplesPerRepetition);
+
+    for (int i = 0; i < repetitions; ++i)
+    {
+        const auto startCycles = readCycleCounter();
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        repetition();
+
+        const auto endTicks = juce::Time::getHighResolutionTicks();
+        const auto endCycles = readCycleCounter();
+
+        const double ns = static_cast<double>(endTicks - startTicks) * nsPerTick;
+        nsPerSample[static_cast<size_t>(i)] = ns / samples;
+
+#if BENCHMARK_HAS_TSC
+        cyclesPerSample[static_cast<size_t>(i)] = static_cast<double>(endCycles - startCycles) / samples;
+#else
+        juce::ignoreUnused(startCycles, endCycles);
+        cyclesPerSample[static_cast<size_t>(i)] = ns * juce::SystemStats::getCpuSpeedInMegahertz() * 1.0e-3 / samples;
+#endif
+    }
+
+    std::sort(nsPerSample.begin(), nsPerSample.end());
+    std::sort(cyclesPerSample.begin(), cyclesPerSample.end());
+
+    // Nearest rank percentiles
+    const auto rank = [repetitions](double p)
+        {
+            return static_cast<size_t>(juce::jlimit(0, repetitions - 1,
+                static_cast<int>(std::ceil(p * repetitions)) - 1));
+        };
+
+    Result result;
+    result.benchmarkCase = benchmarkCase;
+    result.repetitions = repetitions;
+    result.samplesPerRepetition = samplesPerRepetition;
+    result.minNsPerSample = nsPerSample.front();
+    result.medianNsPerSample = nsPerSample[rank(0.5)];
+    result.p99NsPerSample = nsPerSample[rank(0.99)];
+    result.samplesPerSecond = result.medianNsPerSample > 0.0 ? 1.0e9 / result.medianNsPerSample : 0.0;
+    result.medianCyclesPerSample = cyclesPerSample[rank(0.5)];
+    return result;
+}
+
+juce::int64 BenchmarkRunner::readCycleCounter()
+{
+#if BENCHMARK_HAS_TSC
+    return static_cast<juce::int64>(__rdtsc());
+#else
+    return 0;
+#endif
+}
+
+juce::String BenchmarkRunner::formatTable() const
+{
+    juce::String table;
+    table << juce::String("kernel").paddedRight(' ', 34)
+          << juce::String("block").paddedLeft(' ', 7)
+          << juce::String("rate").paddedLeft(' ', 8)
+          << juce::String("ch").paddedLeft(' ', 4)
+          << juce::String("ns/smp").paddedLeft(' ', 10)
+          << juce::String("p99").paddedLeft(' ', 10)
+          << juce::String("Msmp/s").paddedLeft(' ', 10)
+          << juce::String("cyc/smp").paddedLeft(' ', 10) << "\n";
+
+    for (const auto& r : results)
+    {
+        const auto& c = r.benchmarkCase;
+        table << c.kernel.paddedRight(' ', 34)
+              << juce::String(c.blockSize).paddedLeft(' ', 7)
+              << juce::String(juce::roundToInt(c.sampleRate)).paddedLeft(' ', 8)
+              << juce::String(c.numChannels).paddedLeft(' ', 4)
+              << juce::String(r.medianNsPerSample, 3).paddedLeft(' ', 10)
+              << juce::String(r.p99NsPerSample, 3).paddedLeft(' ', 10)
+              << juce::String(r.samplesPerSecond * 1.0e-6, 2).paddedLeft(' ', 10)
+              << juce::String(r.medianCyclesPerSample, 2).paddedLeft(' ', 10) << "\n";
+    }
+
+    return table;
+}
+
+juce::String BenchmarkRunner::toJSON() const
+{
+    auto* machine = new juce::DynamicObject();
+    machine->setProperty("cpu", juce::SystemStats::getCpuModel());
+    machine->setProperty("cpuMHz", juce::SystemStats::getCpuSpeedInMegahertz());
+    machine->setProperty("numCpus", juce::SystemStats::getNumCpus());
+    machine->setProperty("os", juce::SystemStats::getOperatingSystemName());
+#if BENCHMARK_HAS_TSC
+    machine->setProperty("cycleSource", "tsc");
+#else
+    machine->setProperty("cycleSource", "estimated");
+#endif
+
+    auto* opts = new juce::DynamicObject();
+    opts->setProperty("warmUpRepetitions", options.warmUpRepetitions);
+    opts->setProperty("repetitions", options.repetitions);
+    opts->setProperty("samplesPerRepetition", options.samplesPerRepetition);
+
+    juce::Array<juce::var> list;
+    for (const auto& r : results)
+    {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("kernel", r.benchmarkCase.kernel);
+        entry->setProperty("blockSize", r.benchmarkCase.blockSize);
+        entry->setProperty("sampleRate", r.benchmarkCase.sampleRate);
+        entry->setProperty("numChannels", r.benchmarkCase.numChannels);
+        entry->setProperty("repetitions", r.repetitions);
+        entry->setProperty("samplesPerRepetition", r.samplesPerRepetition);
+        entry->setProperty("medianNsPerSample", r.medianNsPerSample);
+        entry->setProperty("p99NsPerSample", r.p99NsPerSample);
+        entry->setProperty("minNsPerSample", r.minNsPerSample);
+        entry->setProperty("samplesPerSecond", r.samplesPerSecond);
+        entry->setProperty("medianCyclesPerSample", r.medianCyclesPerSample);
+        list.add(juce::var(entry));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("machine", juce::var(machine));
+    root->setProperty("options", juce::var(opts));
+    root->setProperty("results", list);
+
+    return juce::JSON::toString(juce::var(root));
+}
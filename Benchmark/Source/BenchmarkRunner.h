@@ -0,0 +1,108 @@
+/*
+ * This file defines BenchmarkRunner, the timing harness of the kernel micro-benchmarks.
+ *
+ * Each benchmark case (kernel, block size, sample rate, channel count) is measured as follows:
+ * - A repetition processes a fixed number of samples, block by block, through the kernel.
+ * - The warm-up repetitions are run first and discarded (caches, branch predictors, denormals).
+ * - The timed repetitions are sorted, the report uses their median and 99th percentile.
+ * - ns/sample, samples/s and cycles/sample count sample frames, i.e. one sample of every channel.
+ *
+ * Times come from juce::Time::getHighResolutionTicks(). Cycles are read from the time stamp
+ * counter on x86 (reference cycles, not core cycles), elsewhere they are estimated from the
+ * nominal CPU clock reported by juce::SystemStats.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+#include <vector>
+
+class BenchmarkRunner
+{
+public:
+    struct Options
+    {
+        int warmUpRepetitions = 5;
+        int repetitions = 50;
+        int samplesPerRepetition = 1 << 16;     // per channel, rounded up to whole blocks
+
+        std::vector<int> blockSizes{ 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+        std::vector<double> sampleRates{ 44100.0, 48000.0, 96000.0 };
+        std::vector<int> channelCounts{ 1, 2 };
+
+        juce::StringArray filter;               // only kernels whose name contains one of these
+        juce::File jsonFile;                    // empty => JSON goes to stdout
+    };
+
+    struct Case
+    {
+        juce::String kernel;
+        int blockSize = 0;
+        double sampleRate = 0.0;
+        int numChannels = 0;
+    };
+
+    struct Result
+    {
+        Case benchmarkCase;
+        int repetitions = 0;
+        juce::int64 samplesPerRepetition = 0;   // per channel
+
+        double medianNsPerSample = 0.0;
+        double p99NsPerSample = 0.0;
+        double minNsPerSample = 0.0;
+        double samplesPerSecond = 0.0;          // from the median
+        double medianCyclesPerSample = 0.0;
+    };
+
+    // Processes one block of blockSize samples; called repeatedly for a repetition
+    using BlockFunction = std::function<void()>;
+
+    explicit BenchmarkRunner(Options options);
+
+    const Options& getOptions() const { return options; }
+
+    bool isSelected(const juce::String& kernel) const;
+
+    // Number of blocks of a repetition for the given block size
+    int getBlocksPerRepetition(int blockSize) const;
+
+    // Times the case and stores the result; processBlock must already be set up for it
+    void run(const Case& benchmarkCase, const BlockFunction& processBlock);
+
+    // Times a whole-signal kernel: one call of processSignal is one repetition of numSamples
+    void runSignal(const Case& benchmarkCase, juce::int64 numSamples, int repetitions, const BlockFunction& processSignal);
+
+    const std::vector<Result>& getResults() const { return results; }
+
+    // One line per case for the console
+    juce::String formatTable() const;
+
+    // {"machine": {...}, "options": {...}, "results": [...]}
+    juce::String toJSON() const;
+
+private:
+    Result measure(const Case& benchmarkCase, juce::int64 samplesPerRepetition, int warmUp, int repetitions,
+        const std::function<void()>& repetition) const;
+
+    static juce::int64 readCycleCounter();
+
+    Options options;
+    std::vector<Result> results;
+};
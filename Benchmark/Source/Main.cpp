@@ -0,0 +1,376 @@
+/*
+ * This file contains the entry point of the kernel micro-benchmarks.
+ *
+ * Benchmarked kernels (at every block size, sample rate and channel count):
+ * - GainComputer::applyCompressionToBuffer (exact and fast math)
+ * - LevelDetector::applyPeakDetector / applyRMSDetector
+ * - LevelEnvelopeFollower::updatePeak
+ * - Compressor::applyPeakCompression / applyRMSCompression (fused and reference paths)
+ * - Compressor::process (real-time path)
+ *
+ * The Metrics functions work on whole signals, they are run once per sample rate and channel
+ * count on --metrics-seconds of audio (block size 0 in the report).
+ *
+ * Every block kernel copies its input block from a longer test signal first, so in-place
+ * kernels never run on their own output. The copy is part of the measured time.
+ *
+ * Usage:
+ *   PeakRMSCompressorBenchmark [--repetitions N] [--warmup N] [--samples N]
+ *       [--block-sizes 32,64,...] [--sample-rates 44100,48000,...] [--channels 1,2]
+ *       [--filter name,...] [--metrics-seconds S] [--json file]
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <JuceHeader.h>
+#include "BenchmarkRunner.h"
+#include "../../Source/dsp/include/Compressor.h"
+#include "../../Source/dsp/include/GainComputer.h"
+#include "../../Source/dsp/include/LevelDetector.h"
+#include "../../Source/dsp/include/LevelEnvelopeFollower.h"
+#include "../../Source/metrics/include/Metrics.h"
+
+namespace
+{
+    // Test signal
+    //==============================================================================
+
+    // Noise with a slow amplitude envelope, so the compressors move between idle, attack and release
+    juce::AudioBuffer<float> makeTestSignal(int numChannels, int numSamples, double sampleRate)
+    {
+        juce::AudioBuffer<float> signal(numChannels, numSamples);
+        juce::Random random(0x5eed);
+
+        const double envelopeRate = 2.0 * juce::MathConstants<double>::pi * 3.0 / sampleRate;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* data = signal.getWritePointer(ch);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float envelope = 0.05f + 0.9f * static_cast<float>(0.5 + 0.5 * std::sin(envelopeRate * i));
+                data[i] = envelope * (2.0f * random.nextFloat() - 1.0f);
+            }
+        }
+        return signal;
+    }
+
+    // Hands out consecutive blocks of the test signal, copied into a work buffer
+    class BlockSource
+    {
+    public:
+        BlockSource(int numChannels, int blockSize, double sampleRate)
+            : signal(makeTestSignal(numChannels, (1 << 16) + blockSize, sampleRate)),
+              block(numChannels, blockSize)
+        {
+        }
+
+        juce::AudioBuffer<float>& next()
+        {
+            const int blockSize = block.getNumSamples();
+            for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                block.copyFrom(ch, 0, signal, ch, position, blockSize);
+
+            position += blockSize;
+            if (position + blockSize > signal.getNumSamples())
+                position = 0;
+
+            return block;
+        }
+
+    private:
+        juce::AudioBuffer<float> signal;
+        juce::AudioBuffer<float> block;
+        int position = 0;
+    };
+
+    void setDefaultParameters(Compressor& compressor)
+    {
+        compressor.setThreshold(-24.0f);
+        compressor.setRatio(4.0f);
+        compressor.setAttack(10.0f);
+        compressor.setRelease(100.0f);
+        compressor.setKnee(6.0f);
+        compressor.setMakeup(0.0f);
+    }
+
+    // Block kernels
+    //==============================================================================
+
+    void benchmarkGainComputer(BenchmarkRunner& runner, const BenchmarkRunner::Case& c,
+        GainComputer::MathMode mode)
+    {
+        GainComputer gainComputer;
+        gainComputer.setThreshold(-24.0f);
+        gainComputer.setRatio(4.0f);
+        gainComputer.setKnee(6.0f);
+        gainComputer.setMathMode(mode);
+
+        BlockSource source(c.numChannels, c.blockSize, c.sampleRate);
+        runner.run(c, [&]()
+            {
+                auto& block = source.next();
+                for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                    gainComputer.applyCompressionToBuffer(block.getWritePointer(ch), block.getNumSamples());
+            });
+    }
+
+    void benchmarkLevelDetector(BenchmarkRunner& runner, const BenchmarkRunner::Case& c, bool isRMS)
+    {
+        std::vector<LevelDetector> detectors(static_cast<size_t>(c.numChannels));
+        for (auto& d : detectors)
+        {
+            d.prepare(c.sampleRate);
+            d.setAttack(0.010);
+            d.setRelease(0.100);
+        }
+
+        BlockSource source(c.numChannels, c.blockSize, c.sampleRate);
+        runner.run(c, [&]()
+            {
+                auto& block = source.next();
+                for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                {
+                    auto* data = block.getWritePointer(ch);
+                    juce::FloatVectorOperations::abs(data, data, block.getNumSamples());
+
+                    if (isRMS) detectors[static_cast<size_t>(ch)].applyRMSDetector(data, block.getNumSamples());
+                    else       detectors[static_cast<size_t>(ch)].applyPeakDetector(data, block.getNumSamples());
+                }
+            });
+    }
+
+    void benchmarkEnvelopeFollower(BenchmarkRunner& runner, const BenchmarkRunner::Case& c)
+    {
+        LevelEnvelopeFollower follower;
+        follower.prepare(c.sampleRate);
+        follower.setPeakDecay(0.3f);
+
+        BlockSource source(c.numChannels, c.blockSize, c.sampleRate);
+        runner.run(c, [&]()
+            {
+                auto& block = source.next();
+                follower.updatePeak(block.getArrayOfReadPointers(), block.getNumChannels(), block.getNumSamples());
+            });
+    }
+
+    enum class CompressorEntry { PeakCompression, RMSCompression, Process };
+
+    void benchmarkCompressor(BenchmarkRunner& runner, const BenchmarkRunner::Case& c,
+        CompressorEntry entry, Compressor::ProcessingMode mode)
+    {
+        Compressor compressor;
+        compressor.prepare({ c.sampleRate, static_cast<juce::uint32>(c.blockSize), static_cast<juce::uint32>(c.numChannels) });
+        compressor.setProcessingMode(mode);
+        setDefaultParameters(compressor);
+
+        BlockSource source(c.numChannels, c.blockSize, c.sampleRate);
+        runner.run(c, [&]()
+            {
+                auto& block = source.next();
+                switch (entry)
+                {
+                case CompressorEntry::PeakCompression:
+                    compressor.applyPeakCompression(block, block.getNumSamples(), block.getNumChannels(), false);
+                    break;
+                case CompressorEntry::RMSCompression:
+                    compressor.applyRMSCompression(block, block.getNumSamples(), block.getNumChannels(), false);
+                    break;
+                case CompressorEntry::Process:
+                    compressor.process(block, false);
+                    break;
+                }
+            });
+    }
+
+    // Whole-signal kernels
+    //==============================================================================
+
+    void compressSignal(Compressor& compressor, bool isRMS, const juce::AudioBuffer<float>& source,
+        juce::AudioBuffer<float>& destination, juce::AudioBuffer<float>& gainReduction, int chunkSize)
+    {
+        const int numChannels = source.getNumChannels();
+        juce::AudioBuffer<float> chunk(numChannels, chunkSize);
+
+        for (int pos = 0; pos < source.getNumSamples(); pos += chunkSize)
+        {
+            const int n = juce::jmin(chunkSize, source.getNumSamples() - pos);
+            for (int ch = 0; ch < numChannels; ++ch)
+                chunk.copyFrom(ch, 0, source, ch, pos, n);
+
+            if (isRMS) compressor.applyRMSCompression(chunk, n, numChannels, true);
+            else       compressor.applyPeakCompression(chunk, n, numChannels, true);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                destination.copyFrom(ch, pos, chunk, ch, 0, n);
+                gainReduction.copyFrom(ch, pos, compressor.getGainReductionSignal(), ch, 0, n);
+            }
+        }
+    }
+
+    void benchmarkMetrics(BenchmarkRunner& runner, double sampleRate, int numChannels, double seconds)
+    {
+        const int numSamples = static_cast<int>(seconds * sampleRate);
+        const int chunkSize = 1024;
+
+        auto uncompressed = makeTestSignal(numChannels, numSamples, sampleRate);
+        juce::AudioBuffer<float> peakSignal(numChannels, numSamples), peakGR(numChannels, numSamples);
+        juce::AudioBuffer<float> rmsSignal(numChannels, numSamples), rmsGR(numChannels, numSamples);
+
+        Compressor peak, rms;
+        for (auto* compressor : { &peak, &rms })
+        {
+            compressor->prepare({ sampleRate, static_cast<juce::uint32>(chunkSize), static_cast<juce::uint32>(numChannels) });
+            setDefaultParameters(*compressor);
+        }
+        compressSignal(peak, false, uncompressed, peakSignal, peakGR, chunkSize);
+        compressSignal(rms, true, uncompressed, rmsSignal, rmsGR, chunkSize);
+
+        Metrics metrics;
+        metrics.prepare(sampleRate);
+        metrics.setUncompressedSignal(&uncompressed);
+        metrics.setPeakCompressedSignal(&peakSignal);
+        metrics.setPeakGainReductionSignal(&peakGR);
+        metrics.setRMSCompressedSignal(&rmsSignal);
+        metrics.setRMSGainReductionSignal(&rmsGR);
+
+        const int repetitions = juce::jmax(3, runner.getOptions().repetitions / 10);
+
+        if (runner.isSelected("Metrics::extractMetrics"))
+            runner.runSignal({ "Metrics::extractMetrics", 0, sampleRate, numChannels }, numSamples, repetitions,
+                [&]() { metrics.setNumThreads(0); metrics.extractMetrics(); });
+
+        if (runner.isSelected("Metrics::extractMetrics (serial)"))
+            runner.runSignal({ "Metrics::extractMetrics (serial)", 0, sampleRate, numChannels }, numSamples, repetitions,
+                [&]() { metrics.setNumThreads(1); metrics.extractMetrics(); });
+
+        if (runner.isSelected("Metrics::extractMetrics (serial, exact percentiles)"))
+            runner.runSignal({ "Metrics::extractMetrics (serial, exact percentiles)", 0, sampleRate, numChannels }, numSamples, repetitions,
+                [&]() { metrics.setNumThreads(1); metrics.setExactPercentiles(true); metrics.extractMetrics(); metrics.setExactPercentiles(false); });
+
+        if (runner.isSelected("Metrics::getGainReductionStatistics"))
+            runner.runSignal({ "Metrics::getGainReductionStatistics", 0, sampleRate, numChannels }, numSamples, repetitions,
+                [&]() { juce::ignoreUnused(metrics.getGainReductionStatistics(peakGR)); });
+    }
+
+    // Command line
+    //==============================================================================
+
+    template <typename T>
+    std::vector<T> parseList(const juce::String& text)
+    {
+        std::vector<T> values;
+        for (const auto& token : juce::StringArray::fromTokens(text, ",", ""))
+            if (token.trim().isNotEmpty())
+                values.push_back(static_cast<T>(token.trim().getDoubleValue()));
+        return values;
+    }
+
+    BenchmarkRunner::Options parseOptions(const juce::ArgumentList& args, double& metricsSeconds)
+    {
+        BenchmarkRunner::Options options;
+
+        if (args.containsOption("--repetitions"))
+            options.repetitions = juce::jmax(1, args.getValueForOption("--repetitions").getIntValue());
+        if (args.containsOption("--warmup"))
+            options.warmUpRepetitions = juce::jmax(0, args.getValueForOption("--warmup").getIntValue());
+        if (args.containsOption("--samples"))
+            options.samplesPerRepetition = juce::jmax(1, args.getValueForOption("--samples").getIntValue());
+        if (args.containsOption("--block-sizes"))
+            options.blockSizes = parseList<int>(args.getValueForOption("--block-sizes"));
+        if (args.containsOption("--sample-rates"))
+            options.sampleRates = parseList<double>(args.getValueForOption("--sample-rates"));
+        if (args.containsOption("--channels"))
+            options.channelCounts = parseList<int>(args.getValueForOption("--channels"));
+        if (args.containsOption("--filter"))
+            options.filter = juce::StringArray::fromTokens(args.getValueForOption("--filter"), ",", "");
+        if (args.containsOption("--json"))
+            options.jsonFile = args.getFileForOption("--json");
+        if (args.containsOption("--metrics-seconds"))
+            metricsSeconds = juce::jmax(0.1, args.getValueForOption("--metrics-seconds").getDoubleValue());
+
+        options.filter.removeEmptyStrings();
+        return options;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        std::cout << "PeakRMSCompressorBenchmark [--repetitions N] [--warmup N] [--samples N]\n"
+                     "    [--block-sizes 32,64,...] [--sample-rates 44100,48000,...] [--channels 1,2]\n"
+                     "    [--filter name,...] [--metrics-seconds S] [--json file]\n";
+        return 0;
+    }
+
+    double metricsSeconds = 10.0;
+    BenchmarkRunner runner(parseOptions(args, metricsSeconds));
+    const auto& options = runner.getOptions();
+
+    using Mode = Compressor::ProcessingMode;
+
+    for (const double sampleRate : options.sampleRates)
+    {
+        for (const int numChannels : options.channelCounts)
+        {
+            for (const int blockSize : options.blockSizes)
+            {
+                const auto makeCase = [&](const juce::String& kernel)
+                    {
+                        return BenchmarkRunner::Case{ kernel, blockSize, sampleRate, numChannels };
+                    };
+
+                const auto bench = [&](const juce::String& kernel, const std::function<void(const BenchmarkRunner::Case&)>& run)
+                    {
+                        if (runner.isSelected(kernel))
+                            run(makeCase(kernel));
+                    };
+
+                bench("GainComputer::applyCompressionToBuffer/Exact", [&](auto& c) { benchmarkGainComputer(runner, c, GainComputer::MathMode::Exact); });
+                bench("GainComputer::applyCompressionToBuffer/Fast", [&](auto& c) { benchmarkGainComputer(runner, c, GainComputer::MathMode::Fast); });
+                bench("LevelDetector::applyPeakDetector", [&](auto& c) { benchmarkLevelDetector(runner, c, false); });
+                bench("LevelDetector::applyRMSDetector", [&](auto& c) { benchmarkLevelDetector(runner, c, true); });
+                bench("LevelEnvelopeFollower::updatePeak", [&](auto& c) { benchmarkEnvelopeFollower(runner, c); });
+                bench("Compressor::applyPeakCompression/Fused", [&](auto& c) { benchmarkCompressor(runner, c, CompressorEntry::PeakCompression, Mode::Fused); });
+                bench("Compressor::applyPeakCompression/Reference", [&](auto& c) { benchmarkCompressor(runner, c, CompressorEntry::PeakCompression, Mode::Reference); });
+                bench("Compressor::applyRMSCompression/Fused", [&](auto& c) { benchmarkCompressor(runner, c, CompressorEntry::RMSCompression, Mode::Fused); });
+                bench("Compressor::applyRMSCompression/Reference", [&](auto& c) { benchmarkCompressor(runner, c, CompressorEntry::RMSCompression, Mode::Reference); });
+                bench("Compressor::process", [&](auto& c) { benchmarkCompressor(runner, c, CompressorEntry::Process, Mode::Fused); });
+            }
+
+            benchmarkMetrics(runner, sampleRate, numChannels, metricsSeconds);
+        }
+    }
+
+    std::cerr << runner.formatTable();
+
+    const auto json = runner.toJSON();
+    if (options.jsonFile == juce::File())
+    {
+        std::cout << json << "\n";
+    }
+    else if (!options.jsonFile.replaceWithText(json))
+    {
+        std::cerr << "Unable to write " << options.jsonFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -104,6 +104,10 @@ PeakRMSCompressorWorkbenchAudioProcessorEditor::PeakRMSCompressorWorkbenchAudioP
     addAndMakeVisible(rmsSwitchButton);
     rmsSwitchButton.setButtonText("Switch to RMS");
     rmsSwitchButton.onClick = [this]() { updateParameterState(); };
+
+    addAndMakeVisible(shadowButton);
+    shadowButton.setButtonText("Shadow Processing");
+    shadowButton.onClick = [this]() { updateParameterState(); };
     
     // Add progress bar for tracking the metrics extraction process
     addAndMakeVisible(progressBar);
@@ -125,6 +129,16 @@ PeakRMSCompressorWorkbenchAudioProcessorEditor::PeakRMSCompressorWorkbenchAudioP
     extractMetricsButton.setButtonText("Extract Metrics");
     extractMetricsButton.onClick = [this]() { handleExtractMetrics(); };
 
+    // Add export profile button for writing the processBlock timing report
+    addAndMakeVisible(exportProfileButton);
+    exportProfileButton.setButtonText("Export Profile");
+    exportProfileButton.onClick = [this]() { handleExportProfile(); };
+
+    // Add reset button for the running statistics of shadow processing
+    addAndMakeVisible(resetShadowStatisticsButton);
+    resetShadowStatisticsButton.setButtonText("Reset Statistics");
+    resetShadowStatisticsButton.onClick = [this]() { audioProcessor.resetShadowStatistics(); };
+
     // Add preset combo box and configure onClick() for applying parameters
     addAndMakeVisible(presetComboBox);
     fillPresetComboBox();
@@ -140,6 +154,8 @@ PeakRMSCompressorWorkbenchAudioProcessorEditor::PeakRMSCompressorWorkbenchAudioP
         valueTreeState, "mute", muteButton);
     rmsSwitchButtonAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
         valueTreeState, "isRMS", rmsSwitchButton);
+    shadowButtonAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        valueTreeState, "shadow", shadowButton);
 
     // Peak Sliders attachment
     peakThresholdAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
@@ -173,8 +189,13 @@ PeakRMSCompressorWorkbenchAudioProcessorEditor::PeakRMSCompressorWorkbenchAudioP
     // Add metering
     addAndMakeVisible(meter);
     meter.setMode(Meter::Mode::GR);
+    addAndMakeVisible(shadowMeter);
+    shadowMeter.setMode(Meter::Mode::GR);
+    addAndMakeVisible(shadowStatisticsLabel);
+    shadowStatisticsLabel.setJustificationType(juce::Justification::topLeft);
+    addAndMakeVisible(gainReductionHistory);
 
-    setSize (1000, 600);
+    setSize (1000, 730);
     updateParameterState();
     startTimerHz(60);
 }
@@ -201,6 +222,9 @@ void PeakRMSCompressorWorkbenchAudioProcessorEditor::resized()
     progressBarArea.setWidth(progressBarArea.getWidth() / 2); // Set width to half
     progressBar.setBounds(progressBarArea);
 
+    // Scrolling gain reduction history along the bottom edge
+    gainReductionHistory.setBounds(area.removeFromBottom(80).reduced(5));
+
     // Buttons
     auto buttonWidth = 150;
     auto buttonHeight = 30;
@@ -210,25 +234,34 @@ void PeakRMSCompressorWorkbenchAudioProcessorEditor::resized()
     powerButton.setBounds(10, 10 + verticalOffset, buttonWidth, buttonHeight);
     muteButton.setBounds(10, powerButton.getBottom() + buttonSpacing, buttonWidth, buttonHeight);
     rmsSwitchButton.setBounds(10, muteButton.getBottom() + buttonSpacing, buttonWidth, buttonHeight);
+    shadowButton.setBounds(10, rmsSwitchButton.getBottom() + buttonSpacing, buttonWidth, buttonHeight);
     extractMetricsButton.setBounds(muteButton.getRight() + 20, 10 + verticalOffset, buttonWidth, buttonHeight);
 
     // ComboBox
     presetComboBox.setBounds(extractMetricsButton.getX(),
         extractMetricsButton.getBottom() + buttonSpacing,
         buttonWidth, buttonHeight);
+    exportProfileButton.setBounds(extractMetricsButton.getX(),
+        presetComboBox.getBottom() + buttonSpacing,
+        buttonWidth, buttonHeight);
+    resetShadowStatisticsButton.setBounds(extractMetricsButton.getX(),
+        exportProfileButton.getBottom() + buttonSpacing,
+        buttonWidth, buttonHeight);
 
-    // Meter
-    auto meterWidth = 500;
+    // Meters of the audible and the shadow detector, shadow statistics below them
+    auto meterWidth = 245;
     auto meterHeight = 150;
     auto meterY = 10; 
-    auto meterX = getWidth() - meterWidth - 20;
+    auto meterX = getWidth() - 2 * meterWidth - 30;
 
     meter.setBounds(meterX, meterY, meterWidth, meterHeight);
+    shadowMeter.setBounds(meter.getRight() + 10, meterY, meterWidth, meterHeight);
+    shadowStatisticsLabel.setBounds(meterX, meter.getBottom() + 5, 2 * meterWidth + 10, 40);
 
     // Two columns for sliders
     auto columnSpacing = 20;
     auto slidersArea = area;
-    slidersArea.removeFromTop(130); // Move the sliders area down by 100 pixels
+    slidersArea.removeFromTop(170); // Move the sliders area below the buttons and the shadow statistics
 
     auto leftColumn = slidersArea.removeFromLeft(slidersArea.getWidth() / 2 - columnSpacing);
     auto rightColumn = slidersArea;
@@ -265,22 +298,40 @@ void PeakRMSCompressorWorkbenchAudioProcessorEditor::resized()
 
 void PeakRMSCompressorWorkbenchAudioProcessorEditor::timerCallback()
 {
-    int m = meter.getMode();
-    switch (m)
+    auto updateMeter = [this](Meter& m, float gainReduction)
     {
-    case Meter::Mode::IN:
-        meter.update(audioProcessor.currentInput);
-        break;
-    case Meter::Mode::OUT:
-        meter.update(audioProcessor.currentOutput);
-        break;
-    case Meter::Mode::GR:
-        meter.update(audioProcessor.gainReduction);
-        break;
-    default:
-        break;
+        switch (m.getMode())
+        {
+        case Meter::Mode::IN:
+            m.update(audioProcessor.currentInput);
+            break;
+        case Meter::Mode::OUT:
+            m.update(audioProcessor.currentOutput);
+            break;
+        case Meter::Mode::GR:
+            m.update(gainReduction);
+            break;
+        default:
+            break;
+        }
+    };
+
+    updateMeter(meter, audioProcessor.gainReduction);
+    updateMeter(shadowMeter, audioProcessor.shadowGainReduction);
+
+    if (audioProcessor.isShadowMode)
+    {
+        const auto& statistics = audioProcessor.getShadowStatistics();
+        shadowStatisticsLabel.setText(formatLaneStatistics("Peak", statistics.peak) + "\n"
+            + formatLaneStatistics("RMS", statistics.rms), juce::dontSendNotification);
     }
 
+    // History of the selected detector; the other one is drained, so it doesn't show stale values when selected
+    auto& shownTap = audioProcessor.isRMSMode ? audioProcessor.rmsCompressor.getGainReductionTap() : audioProcessor.peakCompressor.getGainReductionTap();
+    auto& hiddenTap = audioProcessor.isRMSMode ? audioProcessor.peakCompressor.getGainReductionTap() : audioProcessor.rmsCompressor.getGainReductionTap();
+    gainReductionHistory.update(shownTap);
+    hiddenTap.discard();
+
     // Closing the notification for metrics extraction after some time
     if (statusCountdownFrames > 0)
     {
@@ -313,8 +364,15 @@ void PeakRMSCompressorWorkbenchAudioProcessorEditor::updateParameterState()
 
         extractMetricsButton.setEnabled(true);
         rmsSwitchButton.setEnabled(true);
+        shadowButton.setEnabled(true);
         presetComboBox.setEnabled(true);
 
+        const bool isShadowMode = shadowButton.getToggleState();
+        shadowMeter.setEnabled(isShadowMode);
+        shadowMeter.setGUIEnabled(isShadowMode);
+        shadowStatisticsLabel.setVisible(isShadowMode);
+        resetShadowStatisticsButton.setEnabled(isShadowMode);
+
         const bool isRMSMode = rmsSwitchButton.getToggleState();
 
         peakThresholdSlider.setEnabled(!isRMSMode);
@@ -339,8 +397,14 @@ void PeakRMSCompressorWorkbenchAudioProcessorEditor::updateParameterState()
 
         extractMetricsButton.setEnabled(false);
         rmsSwitchButton.setEnabled(false);
+        shadowButton.setEnabled(false);
         presetComboBox.setEnabled(false);
 
+        shadowMeter.setEnabled(false);
+        shadowMeter.setGUIEnabled(false);
+        shadowStatisticsLabel.setVisible(false);
+        resetShadowStatisticsButton.setEnabled(false);
+
         peakThresholdSlider.setEnabled(false);
         peakRatioSlider.setEnabled(false);
         peakAttackSlider.setEnabled(false);
@@ -400,6 +464,10 @@ void PeakRMSCompressorWorkbenchAudioProcessorEditor::handleExtractMetrics()
     audioProcessor.peakCompressor.setPower(true);
     audioProcessor.rmsCompressor.setPower(true);
 
+    // A bypassed compressor still runs its lookahead delay line, which the extraction reallocates,
+    // so processBlock isn't called until the extraction has finished
+    audioProcessor.suspendProcessing(true);
+
     progressBar.setVisible(true);
     progressValue = 0.0;
 
@@ -409,10 +477,11 @@ void PeakRMSCompressorWorkbenchAudioProcessorEditor::handleExtractMetrics()
     // Let the metrics extraction run in a separate thread
     extractionThread = std::thread([this, &metricsExtractionEngine, file]()
         {
-            metricsExtractionEngine.run(file);
+            juce::String error;
+            const bool extracted = metricsExtractionEngine.run(file, &error);
 
             // After metrics extraction is finished, enable the GUI
-            juce::MessageManager::callAsync([this]()
+            juce::MessageManager::callAsync([this, extracted, error]()
                 { 
                     powerButton.setToggleState(true, juce::dontSendNotification);
                     powerButton.setEnabled(true);
@@ -427,10 +496,12 @@ void PeakRMSCompressorWorkbenchAudioProcessorEditor::handleExtractMetrics()
 
                     audioProcessor.peakCompressor.setPower(false);
                     audioProcessor.rmsCompressor.setPower(false);
+                    audioProcessor.suspendProcessing(false);
 
                     progressBar.setVisible(false);
 
-                    statusLabel.setText("Metrics extraction finished.", juce::dontSendNotification);
+                    statusLabel.setText(extracted ? "Metrics extraction finished." : "Metrics extraction failed: " + error,
+                        juce::dontSendNotification);
                     statusLabel.setVisible(true);
                     statusCountdownFrames = 120; // ~2 seconds at 60 Hz
 
@@ -439,6 +510,33 @@ void PeakRMSCompressorWorkbenchAudioProcessorEditor::handleExtractMetrics()
     }
 
 
+void PeakRMSCompressorWorkbenchAudioProcessorEditor::handleExportProfile()
+{
+    juce::String error;
+    const bool exported = audioProcessor.exportProcessBlockProfile(&error);
+
+    statusLabel.setText(exported ? "processBlock profile exported." : "Profile export failed: " + error,
+        juce::dontSendNotification);
+    statusLabel.setVisible(true);
+    statusCountdownFrames = 120; // ~2 seconds at 60 Hz
+}
+
+
+juce::String PeakRMSCompressorWorkbenchAudioProcessorEditor::formatLaneStatistics(const juce::String& name,
+    const LaneStatistics& statistics)
+{
+    if (statistics.numSamples == 0)
+        return name + ": -";
+
+    const double samples = static_cast<double>(statistics.numSamples);
+    const double outputRms = std::sqrt(statistics.sumOutputSquares / samples);
+
+    return name + ": max GR " + juce::String(statistics.maxGainReduction, 1) + " dB"
+        + ", mean GR " + juce::String(statistics.sumGainReduction / samples, 1) + " dB"
+        + ", output " + juce::String(juce::Decibels::gainToDecibels(outputRms), 1) + " dB RMS";
+}
+
+
 void PeakRMSCompressorWorkbenchAudioProcessorEditor::handlePresetChange() {
     int selectedPresetId = presetComboBox.getSelectedId();
 
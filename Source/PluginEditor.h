@@ -36,6 +36,7 @@
 #include <thread>
 #include "PluginProcessor.h"
 #include "gui/include/Meter.h"
+#include "gui/include/GainReductionHistory.h"
 #include <../Source/util/include/Constants.h>
 
 
@@ -58,6 +59,8 @@ private:
     void fillPresetComboBox();
     void handleExtractMetrics();
     void handlePresetChange();
+    void handleExportProfile();
+    static juce::String formatLaneStatistics(const juce::String& name, const LaneStatistics& statistics);
 
     PeakRMSCompressorWorkbenchAudioProcessor& audioProcessor;
     juce::AudioProcessorValueTreeState& valueTreeState;
@@ -83,9 +86,12 @@ private:
     juce::ToggleButton powerButton;
     juce::ToggleButton muteButton;
     juce::ToggleButton rmsSwitchButton;
+    juce::ToggleButton shadowButton;
 
     // For metrics extraction
     juce::TextButton extractMetricsButton;
+    juce::TextButton exportProfileButton;
+    juce::TextButton resetShadowStatisticsButton;
     double progressValue = 0.0;
     juce::ProgressBar progressBar{ progressValue };
     std::thread extractionThread;
@@ -96,6 +102,9 @@ private:
 
     MeterBackground meterbg;
     Meter meter;
+    Meter shadowMeter;  // detector that isn't audible, in shadow processing mode
+    juce::Label shadowStatisticsLabel;
+    GainReductionHistory gainReductionHistory;
 
     juce::ComboBox presetComboBox;
 
@@ -104,6 +113,7 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> powerButtonAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> muteButtonAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> rmsSwitchButtonAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> shadowButtonAttachment;
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> peakThresholdAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> peakRatioAttachment;
@@ -60,7 +60,11 @@ PeakRMSCompressorWorkbenchAudioProcessor::PeakRMSCompressorWorkbenchAudioProcess
         peakCompressor,
         rmsCompressor,
         metrics,
-        parameters,
+        [this](const juce::String& id)
+        {
+            auto* value = parameters.getRawParameterValue(id);
+            return value != nullptr ? value->load() : 0.0f;
+        },
         MetricsExtractionEngine::Config{ 1024, 20 }
     )
 #endif
@@ -68,6 +72,8 @@ PeakRMSCompressorWorkbenchAudioProcessor::PeakRMSCompressorWorkbenchAudioProcess
     parameters.addParameterListener("power", this);
     parameters.addParameterListener("mute", this);
     parameters.addParameterListener("isRMS", this);
+    parameters.addParameterListener("shadow", this);
+    parameters.addParameterListener("lookahead", this);
 
     parameters.addParameterListener("peak_threshold", this);
     parameters.addParameterListener("peak_ratio", this);
@@ -84,10 +90,21 @@ PeakRMSCompressorWorkbenchAudioProcessor::PeakRMSCompressorWorkbenchAudioProcess
     parameters.addParameterListener("rms_makeup", this);
 
     gainReduction = 0.0f;
+    shadowGainReduction = 0.0f;
     currentInput = -std::numeric_limits<float>::infinity();
     currentOutput = -std::numeric_limits<float>::infinity();
 
     formatManager.registerBasicFormats();
+
+    if (Config::decodedAudioCache::enable)
+    {
+        decodedAudioCache = std::make_unique<DecodedAudioCache>(
+            DecodedAudioCache::Config{ {}, Config::decodedAudioCache::maxMegabytes << 20 });
+        audioFileLoader.setDecodedAudioCache(decodedAudioCache.get());
+    }
+
+    peakCompressor.setProfiler(&blockProfiler);
+    rmsCompressor.setProfiler(&blockProfiler);
 }
 
 PeakRMSCompressorWorkbenchAudioProcessor::~PeakRMSCompressorWorkbenchAudioProcessor()
@@ -160,8 +177,14 @@ void PeakRMSCompressorWorkbenchAudioProcessor::changeProgramName(int index, cons
 //==============================================================================
 void PeakRMSCompressorWorkbenchAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    peakCompressor.prepare({ sampleRate, static_cast<uint32>(samplesPerBlock), 2 });
-    rmsCompressor.prepare({ sampleRate, static_cast<uint32>(samplesPerBlock), 2 });
+    const auto numChannels = static_cast<uint32>(juce::jmax(1, getTotalNumInputChannels()));
+    peakCompressor.prepare({ sampleRate, static_cast<uint32>(samplesPerBlock), numChannels });
+    rmsCompressor.prepare({ sampleRate, static_cast<uint32>(samplesPerBlock), numChannels });
+
+    // Lookahead delays the audio path, the host compensates for it
+    setLatencySamples(peakCompressor.getLatencySamples());
+
+    blockProfiler.prepare(sampleRate);
 
     inLevelFollower.prepare(sampleRate);
     outLevelFollower.prepare(sampleRate);
@@ -184,12 +207,9 @@ bool PeakRMSCompressorWorkbenchAudioProcessor::isBusesLayoutSupported(const Buse
     juce::ignoreUnused(layouts);
     return true;
 #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-        && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any channel layout is supported (mono, stereo, surround, ambisonics),
+    // all channels are linked into a single sidechain by the compressor
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -208,29 +228,46 @@ bool PeakRMSCompressorWorkbenchAudioProcessor::isBusesLayoutSupported(const Buse
 void PeakRMSCompressorWorkbenchAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    blockProfiler.beginBlock();
+
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     const auto numSamples = buffer.getNumSamples();
 
-    // Compressor design supports only two-channel (stereo) audio format
-    jassert(totalNumInputChannels == 2);
-    jassert(totalNumOutputChannels == 2);
+    // The compressor links all input channels, output layout has to match the input layout
+    jassert(totalNumInputChannels == totalNumOutputChannels);
 
     // Clear input buffer
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
     // Update input peak metering
-    inLevelFollower.updatePeak(buffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples);
-    currentInput = Decibels::gainToDecibels(inLevelFollower.getPeak());
+    {
+        BlockProfiler::ScopedStage stage(&blockProfiler, BlockProfiler::Metering);
+        inLevelFollower.updatePeak(buffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples);
+        currentInput = Decibels::gainToDecibels(inLevelFollower.getPeak());
+    }
 
-    if (!isRMSMode) {
+    if (isShadowMode) {
+        // Apply the selected compression, the other detector runs alongside it for comparison
+        if (shadowStatisticsResetRequested.exchange(false))
+            shadowStatistics = {};
+
+        Compressor::processDualLane(peakCompressor, rmsCompressor, buffer, isRMSMode, shadowStatistics);
+        gainReduction = isRMSMode ? rmsCompressor.getMaxGainReduction() : peakCompressor.getMaxGainReduction();
+        shadowGainReduction = isRMSMode ? peakCompressor.getMaxGainReduction() : rmsCompressor.getMaxGainReduction();
+        shadowStatisticsSnapshot.publish(shadowStatistics);
+    }
+    else if (!isRMSMode) {
+        // Keeps the RMS lookahead delay line current, so switching to RMS doesn't play stale samples
+        rmsCompressor.writeLookahead(buffer);
         // Apply peak compression
         peakCompressor.process(buffer, isRMSMode);
         // Get max. gain reduction for peak value for gain reduction metering
         gainReduction = peakCompressor.getMaxGainReduction();
     }
     else {
+        peakCompressor.writeLookahead(buffer);
         // Apply rms compression
         rmsCompressor.process(buffer, isRMSMode);
         // Get max. gain reduction value for rms for gain reduction metering
@@ -238,14 +275,17 @@ void PeakRMSCompressorWorkbenchAudioProcessor::processBlock(juce::AudioBuffer<fl
     }
 
     // Update output peak metering
-    outLevelFollower.updatePeak(buffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples);
-    currentOutput = Decibels::gainToDecibels(outLevelFollower.getPeak());
+    {
+        BlockProfiler::ScopedStage stage(&blockProfiler, BlockProfiler::Metering);
+        outLevelFollower.updatePeak(buffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples);
+        currentOutput = Decibels::gainToDecibels(outLevelFollower.getPeak());
+    }
 
     if (isMuted) {
         buffer.clear(); // Silence the processed audio
-        return;
-
     }
+
+    blockProfiler.endBlock(numSamples);
 }
 
 //==============================================================================
@@ -283,6 +323,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout PeakRMSCompressorWorkbenchAu
     params.push_back(std::make_unique<AudioParameterBool>("power", "Power", true));
     params.push_back(std::make_unique<AudioParameterBool>("mute", "Mute", false));
     params.push_back(std::make_unique<juce::AudioParameterBool>("isRMS", "Use RMS Detection", false));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("shadow", "Shadow Processing", false));
 
     auto thresholdRange = NormalisableRange<float>(Constants::Parameter::thresholdStart,
         Constants::Parameter::thresholdEnd,
@@ -308,6 +349,15 @@ juce::AudioProcessorValueTreeState::ParameterLayout PeakRMSCompressorWorkbenchAu
         Constants::Parameter::releaseEnd,
         Constants::Parameter::releaseInterval);
 
+    auto lookaheadRange = NormalisableRange<float>(Constants::Parameter::lookaheadStart,
+        Constants::Parameter::lookaheadEnd,
+        Constants::Parameter::lookaheadInterval);
+
+    params.push_back(std::make_unique<AudioParameterFloat>("lookahead",
+        "Lookahead",
+        lookaheadRange,
+        0));
+
     params.push_back(std::make_unique<AudioParameterFloat>("peak_threshold",
         "Peak Threshold",
         thresholdRange,
@@ -381,6 +431,13 @@ void PeakRMSCompressorWorkbenchAudioProcessor::parameterChanged(const juce::Stri
     }
     else if (parameterID == "mute") isMuted = static_cast<bool>(newValue);
     else if (parameterID == "isRMS") isRMSMode = static_cast<bool>(newValue);
+    else if (parameterID == "shadow") isShadowMode = static_cast<bool>(newValue);
+    else if (parameterID == "lookahead") {
+        // Shared by both detectors, so switching the detector doesn't change the latency
+        peakCompressor.setLookahead(newValue);
+        rmsCompressor.setLookahead(newValue);
+        setLatencySamples(peakCompressor.getLatencySamples());
+    }
 
     // Peak parameters
     else if (parameterID == "peak_threshold") peakCompressor.setThreshold(newValue);
@@ -399,6 +456,22 @@ void PeakRMSCompressorWorkbenchAudioProcessor::parameterChanged(const juce::Stri
     else if (parameterID == "rms_makeup") rmsCompressor.setMakeup(newValue);
 }
 
+const Compressor::DualLaneStatistics& PeakRMSCompressorWorkbenchAudioProcessor::getShadowStatistics()
+{
+    shadowStatisticsSnapshot.pull();
+    return shadowStatisticsSnapshot.current();
+}
+
+void PeakRMSCompressorWorkbenchAudioProcessor::resetShadowStatistics()
+{
+    shadowStatisticsResetRequested = true;
+}
+
+bool PeakRMSCompressorWorkbenchAudioProcessor::exportProcessBlockProfile(juce::String* error)
+{
+    return dataExport.exportProfile(blockProfiler.getStatistics().format(), error);
+}
+
 void PeakRMSCompressorWorkbenchAudioProcessor::updateCompressionMode(bool isRMSMode)
 {
     if (isRMSMode) {
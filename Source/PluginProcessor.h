@@ -48,6 +48,9 @@
 #include <../Source/metrics/include/DataExport.h>
 #include <../Source/metrics/include/Metrics.h>
 
+// Timing instrumentation
+#include <../Source/util/include/BlockProfiler.h>
+
 // Constants, presets and config
 #include <../Source/util/include/Constants.h>
 #include <../Source/util/include/Presets.h>
@@ -105,6 +108,24 @@ public:
     */
     void updateCompressionMode(bool);
 
+    /**
+    * Running statistics of both detectors in shadow processing mode, published by the audio
+    * thread once per block. Call from the message thread only.
+    */
+    const Compressor::DualLaneStatistics& getShadowStatistics();
+    void resetShadowStatistics();
+
+    /**
+    * processBlock timing statistics (histograms, deadline overruns, per-stage times), published
+    * by the audio thread after every block. Call from the message thread only.
+    */
+    BlockProfiler& getBlockProfiler() {
+        return blockProfiler;
+    }
+
+    // Writes the current processBlock timing statistics to the output folder
+    bool exportProcessBlockProfile(juce::String* error = nullptr);
+
 
     // PARAMETERS HANDLING
     //==============================================================================
@@ -133,6 +154,7 @@ public:
     juce::AudioProcessorValueTreeState parameters;
 
     std::atomic<float> gainReduction;
+    std::atomic<float> shadowGainReduction; // of the detector that isn't audible, in shadow mode
     std::atomic<float> currentInput;
     std::atomic<float> currentOutput;
 
@@ -141,6 +163,7 @@ public:
 
     bool isRMSMode{ false };
     bool isMuted{ false };
+    bool isShadowMode{ false };
 
     std::map<int, PresetStruct> createPresetParameters();
     std::map<int, PresetStruct> PresetParameters;
@@ -158,6 +181,14 @@ private:
     LevelEnvelopeFollower inLevelFollower;
     LevelEnvelopeFollower outLevelFollower;
 
+    // Timing of processBlock
+    BlockProfiler blockProfiler;
+
+    // Shadow processing statistics, accumulated on the audio thread
+    Compressor::DualLaneStatistics shadowStatistics;
+    ParameterSnapshot<Compressor::DualLaneStatistics> shadowStatisticsSnapshot;
+    std::atomic<bool> shadowStatisticsResetRequested{ false };
+
     juce::AudioFormatManager formatManager; // Handles audio format readers
 
 
@@ -171,6 +202,7 @@ private:
     Metrics metrics;
 
     // Metrics extraction pipeline
+    std::unique_ptr<DecodedAudioCache> decodedAudioCache;   // Config::decodedAudioCache::enable
     AudioFileLoader audioFileLoader;
     DataExport dataExport;
     MetricsExtractionEngine metricsExtractionEngine;
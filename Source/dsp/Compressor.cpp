@@ -42,11 +42,62 @@ Compressor::~Compressor()
 void Compressor::prepare(const juce::dsp::ProcessSpec& ps)
 {
 	procSpec = ps;
+    prepareBuffers(ps);
+
+    // Two seconds of gain reduction history, one value per sub-block
+    gainReductionTap.prepare(static_cast<int>(ps.sampleRate * 2.0) / subBlockSize);
+}
+
+// All scratch memory (sidechain, lookahead delay line) is allocated here, never while processing
+void Compressor::prepareBuffers(const juce::dsp::ProcessSpec& ps)
+{
     levelDetector.prepare(ps.sampleRate);
-	originalSignal.setSize(2, ps.maximumBlockSize);
-	sidechainSignal.resize(ps.maximumBlockSize, 0.0f);
-	rawSidechainSignal = sidechainSignal.data();
-	originalSignal.clear();
+    sampleRate = ps.sampleRate;
+
+    // process() works in sub-blocks of up to subBlockSize samples, whatever block size the host announced
+    const int maxBlockSamples = juce::jmax(subBlockSize, static_cast<int>(ps.maximumBlockSize));
+    const auto maxBlockSize = static_cast<size_t>(maxBlockSamples);
+    sidechainSignal.resize(maxBlockSize, 0.0f);
+    sidechainRight.resize(maxBlockSize, 0.0f);
+    linkedSidechainSignal.resize(maxBlockSize, 0.0f);
+    lookaheadGain.resize(maxBlockSize, 0.0f);
+    rawSidechainSignal = sidechainSignal.data();
+
+    // Shadow lane copy and gain reduction of a sub-block, so shadow processing doesn't allocate
+    shadowBlock.setSize(juce::jmax(2, static_cast<int>(ps.numChannels)), subBlockSize);
+    gainReductionSignal.setSize(juce::jmax(2, static_cast<int>(ps.numChannels)), maxBlockSamples);
+
+    // Power-of-two ring, so wrapping the positions is a single mask
+    const int maxLookaheadSamples = static_cast<int>(std::ceil(maxLookaheadMs * 0.001 * ps.sampleRate));
+    delayLine.setSize(juce::jmax(2, static_cast<int>(ps.numChannels)),
+        juce::nextPowerOfTwo(maxLookaheadSamples + maxBlockSamples));
+    delayLine.clear();
+    delayWritePosition = 0;
+    updateTargetLookaheadSamples();
+    latchLookahead();
+
+    // Detector coefficients of the attack/release parameter grid, so that parameter changes
+    // don't compute exp() on the calling thread (some hosts call it on the audio thread)
+    {
+        const juce::SpinLock::ScopedLockType lock(parameterWriteLock);
+
+        detectorCoefficients.resize(maxTabulatedTimeMs + 1);
+        detectorCoefficients[0] = 0.0;
+        for (int ms = 1; ms <= maxTabulatedTimeMs; ++ms)
+            detectorCoefficients[ms] = exp(-1.0 / (sampleRate * (static_cast<float>(ms) * 0.001)));
+
+        pendingParameters.alphaAttack = getDetectorCoefficient(pendingParameters.attackMs);
+        pendingParameters.alphaRelease = getDetectorCoefficient(pendingParameters.releaseMs);
+        parameterSnapshot.publish(pendingParameters);
+    }
+    updateCurveTable();
+
+    smoothedThreshold.reset(sampleRate, parameterSmoothingTime);
+    smoothedRatio.reset(sampleRate, parameterSmoothingTime);
+    smoothedMakeup.reset(sampleRate, parameterSmoothingTime);
+    pullParameters(false);
+
+    controlRateGain = -1.0f;
 }
 
 //==============================================================================
@@ -58,32 +109,175 @@ void Compressor::setPower(bool newPower)
 // PEAK PARAMS
 void Compressor::setThreshold(float thresholdInDb)
 {
-    gainComputer.setThreshold(thresholdInDb);
+    updateParameters([thresholdInDb](Parameters& p) { p.threshold = thresholdInDb; });
 }
 
 void Compressor::setRatio(float rat)
 {
-    gainComputer.setRatio(rat);
+    updateParameters([rat](Parameters& p) { p.ratio = rat; });
 }
 
 void Compressor::setAttack(float attackTimeInMs)
 {
-    levelDetector.setAttack(attackTimeInMs * 0.001);
+    updateParameters([this, attackTimeInMs](Parameters& p) {
+        p.attackMs = attackTimeInMs;
+        p.alphaAttack = getDetectorCoefficient(attackTimeInMs);
+    });
 }
 
 void Compressor::setRelease(float releaseTimeInMs)
 {
-    levelDetector.setRelease(releaseTimeInMs * 0.001);
+    updateParameters([this, releaseTimeInMs](Parameters& p) {
+        p.releaseMs = releaseTimeInMs;
+        p.alphaRelease = getDetectorCoefficient(releaseTimeInMs);
+    });
 }
 
 void Compressor::setKnee(float kneeInDb)
 {
-    gainComputer.setKnee(kneeInDb);
+    updateParameters([kneeInDb](Parameters& p) { p.knee = kneeInDb; });
 }
 
 void Compressor::setMakeup(float makeupGainInDb)
 {
-    makeup = makeupGainInDb;
+    updateParameters([makeupGainInDb](Parameters& p) { p.makeup = makeupGainInDb; });
+}
+
+void Compressor::setProcessingMode(ProcessingMode mode)
+{
+    processingMode = mode;
+}
+
+void Compressor::setMathMode(GainComputer::MathMode mode)
+{
+    gainComputer.setMathMode(mode);
+    updateCurveTable();
+}
+
+void Compressor::updateCurveTable()
+{
+    const auto mode = gainComputer.getMathMode();
+    if (mode != GainComputer::MathMode::DecibelTable && mode != GainComputer::MathMode::LevelTable)
+        return;
+
+    // Same curve as the gain computer of the audio thread will have once smoothing has finished
+    GainComputer curve;
+    {
+        const juce::SpinLock::ScopedLockType lock(parameterWriteLock);
+        curve.setThreshold(pendingParameters.threshold);
+        curve.setRatio(pendingParameters.ratio);
+        curve.setKnee(pendingParameters.knee);
+    }
+
+    const auto kneeCurve = curve.getKneeCurve();
+    if (!pendingCurveTable.matches(kneeCurve)) {
+        pendingCurveTable.build(kneeCurve);
+        curveTableSnapshot.publish(pendingCurveTable);
+    }
+}
+
+void Compressor::setControlRate(int samplesPerControlPoint)
+{
+    jassert(samplesPerControlPoint == 1 || samplesPerControlPoint == 4 || samplesPerControlPoint == 8
+        || samplesPerControlPoint == 16 || samplesPerControlPoint == 32);
+
+    controlInterval = juce::jlimit(1, 32, samplesPerControlPoint);
+    controlRateGain = -1.0f;
+}
+
+void Compressor::setLookahead(float lookaheadTimeInMs)
+{
+    lookaheadMs = juce::jlimit(0.0f, maxLookaheadMs, lookaheadTimeInMs);
+    updateTargetLookaheadSamples();
+}
+
+void Compressor::updateTargetLookaheadSamples()
+{
+    targetLookaheadSamples = static_cast<int>(std::round(lookaheadMs.load() * 0.001 * sampleRate));
+}
+
+void Compressor::latchLookahead()
+{
+    const int target = targetLookaheadSamples.load();
+    if (target != lookaheadSamples) {
+        // The ring content belongs to the old read position
+        lookaheadSamples = target;
+        delayLine.clear();
+        delayWritePosition = 0;
+    }
+}
+
+// PARAMETER SNAPSHOT
+//==============================================================================
+template <typename Change>
+void Compressor::updateParameters(Change&& change)
+{
+    const juce::SpinLock::ScopedLockType lock(parameterWriteLock);
+    change(pendingParameters);
+    parameterSnapshot.publish(pendingParameters);
+}
+
+double Compressor::getDetectorCoefficient(float timeInMs) const
+{
+    const int wholeMs = static_cast<int>(timeInMs);
+    if (static_cast<float>(wholeMs) == timeInMs && wholeMs >= 1 && wholeMs < static_cast<int>(detectorCoefficients.size()))
+        return detectorCoefficients[static_cast<size_t>(wholeMs)];
+
+    return exp(-1.0 / (sampleRate * (timeInMs * 0.001)));
+}
+
+void Compressor::pullParameters(bool smooth)
+{
+    // Valid until the next pull; empty (=> exact curve) until a table math mode is selected
+    curveTableSnapshot.pull();
+    gainComputer.setCurveTable(&curveTableSnapshot.current());
+
+    if (!parameterSnapshot.pull())
+        return;
+
+    const Parameters& p = parameterSnapshot.current();
+    gainComputer.setKnee(p.knee);
+    levelDetector.setTimeConstants(p.attackMs * 0.001, p.alphaAttack, p.releaseMs * 0.001, p.alphaRelease);
+
+    if (smooth) {
+        smoothedThreshold.setTargetValue(p.threshold);
+        smoothedRatio.setTargetValue(p.ratio);
+        smoothedMakeup.setTargetValue(p.makeup);
+    } else {
+        smoothedThreshold.setCurrentAndTargetValue(p.threshold);
+        smoothedRatio.setCurrentAndTargetValue(p.ratio);
+        smoothedMakeup.setCurrentAndTargetValue(p.makeup);
+    }
+
+    if (!isSmoothingParameters())
+        applySmoothedParameters();
+}
+
+bool Compressor::isSmoothingParameters() const
+{
+    return smoothedThreshold.isSmoothing() || smoothedRatio.isSmoothing() || smoothedMakeup.isSmoothing();
+}
+
+void Compressor::applySmoothedParameters()
+{
+    gainComputer.setThreshold(smoothedThreshold.getCurrentValue());
+    gainComputer.setRatio(smoothedRatio.getCurrentValue());
+    makeup = smoothedMakeup.getCurrentValue();
+}
+
+void Compressor::setProfiler(BlockProfiler* newProfiler)
+{
+    profiler = newProfiler;
+}
+
+void Compressor::setChannelLink(ChannelLink mode)
+{
+    channelLink = mode;
+}
+
+void Compressor::setQuietBlockFastPath(bool enabled)
+{
+    quietBlockFastPath = enabled;
 }
 
 
@@ -93,6 +287,36 @@ float Compressor::getMakeup()
     return makeup;
 }
 
+Compressor::ProcessingMode Compressor::getProcessingMode() const
+{
+    return processingMode;
+}
+
+GainComputer::MathMode Compressor::getMathMode() const
+{
+    return gainComputer.getMathMode();
+}
+
+float Compressor::getLookahead() const
+{
+    return lookaheadMs;
+}
+
+int Compressor::getLatencySamples() const
+{
+    return targetLookaheadSamples.load();
+}
+
+Compressor::ChannelLink Compressor::getChannelLink() const
+{
+    return channelLink;
+}
+
+int Compressor::getControlRate() const
+{
+    return controlInterval;
+}
+
 double Compressor::getSampleRate()
 {
     return procSpec.sampleRate;
@@ -103,40 +327,272 @@ float Compressor::getMaxGainReduction()
     return maxGainReduction;
 }
 
-juce::AudioBuffer<float> Compressor::getGainReductionSignal()
+const juce::AudioBuffer<float>& Compressor::getGainReductionSignal() const
 {
     return gainReductionSignal;
 }
 
+GainReductionTap& Compressor::getGainReductionTap()
+{
+    return gainReductionTap;
+}
+
+float Compressor::getAttack()
+{
+    return static_cast<float>(levelDetector.getAttack() * 1000.0);
+}
+
+float Compressor::getRelease()
+{
+    return static_cast<float>(levelDetector.getRelease() * 1000.0);
+}
+
+juce::int64 Compressor::getNumProcessedBlocks() const
+{
+    return numProcessedBlocks.load(std::memory_order_relaxed);
+}
+
+juce::int64 Compressor::getNumQuietBlocks() const
+{
+    return numQuietBlocks.load(std::memory_order_relaxed);
+}
+
+void Compressor::resetBlockCounters()
+{
+    numProcessedBlocks.store(0, std::memory_order_relaxed);
+    numQuietBlocks.store(0, std::memory_order_relaxed);
+}
+
 
 // APPLY COMPRESSION
 //==============================================================================
+// Thin runtime wrapper - selects the compile-time specialized topology once per block
+// and processes the host block in fixed-size sub-blocks, so any block length is accepted
 void Compressor::process(juce::AudioBuffer<float>& buffer, bool isRMSmode) // for real-time compression
 {
     if (!bypassed) {
+        // Stages are only timed for real-time blocks, not for offline extraction
+        const juce::ScopedValueSetter<BlockProfiler*> profiling(activeProfiler, profiler);
+
         const auto numSamples = buffer.getNumSamples();
         const auto numChannels = buffer.getNumChannels();
+        float* const* channels = buffer.getArrayOfWritePointers();
+
+        float blockGainReduction = 0.0f;
+
+        // One delay for the whole host block
+        latchLookahead();
+
+        for (int start = 0; start < numSamples; start += subBlockSize) {
+            const int n = std::min(subBlockSize, numSamples - start);
+            jassert(n <= static_cast<int>(sidechainSignal.size()) && n <= static_cast<int>(lookaheadGain.size())); // prepared?
 
-        jassert(numSamples == static_cast<int>(sidechainSignal.size()));
+            // Refers to the host buffer, no allocation for up to 32 channels
+            juce::AudioBuffer<float> subBlock(channels, numChannels, start, n);
 
-        if (!isRMSmode) {
-            applyPeakCompression(buffer, numSamples, numChannels, false);
+            if (!isRMSmode) {
+                applyPeakCompression(subBlock, n, numChannels, false);
+            } else {
+                applyRMSCompression(subBlock, n, numChannels, false);
+            }
+
+            blockGainReduction = std::min(blockGainReduction, maxGainReduction);
+            gainReductionTap.push(maxGainReduction);
+        }
+
+        // Metering reports the maximum gain reduction of the whole host block
+        maxGainReduction = blockGainReduction;
+    } else {
+        // Uncompressed, but delayed like the compressed signal, so the reported latency holds
+        latchLookahead();
+        delayUnprocessed(buffer);
+    }
+}
+
+// SHADOW (DUAL-LANE) PROCESSING
+//==============================================================================
+void Compressor::processDualLane(Compressor& peak, Compressor& rms, juce::AudioBuffer<float>& buffer,
+    bool isRMSmode, DualLaneStatistics& statistics)
+{
+    Compressor& audible = isRMSmode ? rms : peak;
+    Compressor& shadow = isRMSmode ? peak : rms;
+    LaneStatistics& audibleStatistics = isRMSmode ? statistics.rms : statistics.peak;
+    LaneStatistics& shadowStatistics = isRMSmode ? statistics.peak : statistics.rms;
+
+    if (audible.bypassed) {
+        shadow.writeLookahead(buffer);
+        audible.process(buffer, isRMSmode);
+        return;
+    }
+
+    const juce::ScopedValueSetter<BlockProfiler*> audibleProfiling(audible.activeProfiler, audible.profiler);
+    const juce::ScopedValueSetter<BlockProfiler*> shadowProfiling(shadow.activeProfiler, shadow.profiler);
+
+    const auto numSamples = buffer.getNumSamples();
+    const auto numChannels = buffer.getNumChannels();
+    float* const* channels = buffer.getArrayOfWritePointers();
+
+    float audibleGainReduction = 0.0f;
+    float shadowGainReduction = 0.0f;
+
+    audible.latchLookahead();
+    shadow.latchLookahead();
+
+    for (int start = 0; start < numSamples; start += subBlockSize) {
+        const int n = std::min(subBlockSize, numSamples - start);
+        juce::AudioBuffer<float> subBlock(channels, numChannels, start, n);
+
+        audible.pullParameters(true);
+        shadow.pullParameters(true);
+
+        LaneStatistics audibleStats, shadowStats;
+
+        if (audible.canShareDualLanePass(shadow)) {
+            const float* linkedSidechain = audible.linkSidechain(subBlock, n, numChannels, false);
+
+            if (isRMSmode)
+                runDualLane<RMSDetectorPolicy, PeakDetectorPolicy>(audible, shadow, subBlock.getArrayOfWritePointers(),
+                    numChannels, n, linkedSidechain, audibleStats, shadowStats);
+            else
+                runDualLane<PeakDetectorPolicy, RMSDetectorPolicy>(audible, shadow, subBlock.getArrayOfWritePointers(),
+                    numChannels, n, linkedSidechain, audibleStats, shadowStats);
         } else {
-            applyRMSCompression(buffer, numSamples, numChannels, false);
+            // The shadow lane compresses a copy, taken before the audible lane changes the block
+            jassert(numChannels <= shadow.shadowBlock.getNumChannels() && n <= shadow.shadowBlock.getNumSamples());
+            juce::AudioBuffer<float> shadowCopy(shadow.shadowBlock.getArrayOfWritePointers(), numChannels, n);
+            for (int ch = 0; ch < numChannels; ++ch)
+                shadowCopy.copyFrom(ch, 0, subBlock, ch, 0, n);
+
+            shadow.compressLane(shadowCopy, n, numChannels, !isRMSmode, shadowStats);
+            audible.compressLane(subBlock, n, numChannels, isRMSmode, audibleStats);
         }
+
+        audibleStatistics.merge(audibleStats);
+        shadowStatistics.merge(shadowStats);
+        audibleGainReduction = std::min(audibleGainReduction, audibleStats.maxGainReduction);
+        shadowGainReduction = std::min(shadowGainReduction, shadowStats.maxGainReduction);
+        audible.gainReductionTap.push(audibleStats.maxGainReduction);
+        shadow.gainReductionTap.push(shadowStats.maxGainReduction);
+    }
+
+    // Metering reports the maximum gain reduction of the whole host block, for both lanes
+    audible.maxGainReduction = audibleGainReduction;
+    shadow.maxGainReduction = shadowGainReduction;
+}
+
+bool Compressor::canShareDualLanePass(const Compressor& shadow) const
+{
+    return processingMode == ProcessingMode::Fused && shadow.processingMode == ProcessingMode::Fused
+        && controlInterval == 1 && shadow.controlInterval == 1
+        && lookaheadSamples == 0 && shadow.lookaheadSamples == 0
+        && !isSmoothingParameters() && !shadow.isSmoothingParameters()
+        && gainComputer.getActiveMathMode() == shadow.gainComputer.getActiveMathMode()
+        && channelLink == shadow.channelLink;
+}
+
+template <typename AudiblePolicy, typename ShadowPolicy>
+void Compressor::runDualLane(Compressor& audible, Compressor& shadow, float* const* channels, int numChannels,
+    int numSamples, const float* linkedSidechain, LaneStatistics& audibleStats, LaneStatistics& shadowStats)
+{
+    BlockProfiler::ScopedStage stage(audible.activeProfiler, BlockProfiler::Detector);
+    DetectorState audibleDetector{ audible.levelDetector.getState(), audible.levelDetector.getAlphaAttack(), audible.levelDetector.getAlphaRelease() };
+    DetectorState shadowDetector{ shadow.levelDetector.getState(), shadow.levelDetector.getAlphaAttack(), shadow.levelDetector.getAlphaRelease() };
+
+    // Both lanes use the same math mode, selected once per block
+    switch (audible.gainComputer.getActiveMathMode())
+    {
+    case GainComputer::MathMode::Fast:
+        DualLaneKernel<AudiblePolicy, ShadowPolicy, FastKnee>::process(channels, numChannels, numSamples, linkedSidechain,
+            audibleDetector, audible.gainComputer.getKneeCurve(), audible.makeup,
+            shadowDetector, shadow.gainComputer.getKneeCurve(), shadow.makeup, audibleStats, shadowStats);
+        break;
+    case GainComputer::MathMode::DecibelTable:
+        DualLaneKernel<AudiblePolicy, ShadowPolicy, DecibelTableKnee>::process(channels, numChannels, numSamples, linkedSidechain,
+            audibleDetector, audible.gainComputer.getCurveTable(), audible.makeup,
+            shadowDetector, shadow.gainComputer.getCurveTable(), shadow.makeup, audibleStats, shadowStats);
+        break;
+    case GainComputer::MathMode::LevelTable:
+        DualLaneKernel<AudiblePolicy, ShadowPolicy, LevelTableKnee>::process(channels, numChannels, numSamples, linkedSidechain,
+            audibleDetector, audible.gainComputer.getCurveTable(), audible.makeup,
+            shadowDetector, shadow.gainComputer.getCurveTable(), shadow.makeup, audibleStats, shadowStats);
+        break;
+    default:
+        DualLaneKernel<AudiblePolicy, ShadowPolicy, ExactKnee>::process(channels, numChannels, numSamples, linkedSidechain,
+            audibleDetector, audible.gainComputer.getKneeCurve(), audible.makeup,
+            shadowDetector, shadow.gainComputer.getKneeCurve(), shadow.makeup, audibleStats, shadowStats);
+        break;
+    }
+
+    for (Compressor* lane : { &audible, &shadow }) {
+        lane->numProcessedBlocks.fetch_add(1, std::memory_order_relaxed);
+        // A later control-rate block starts without interpolation
+        lane->controlRateGain = -1.0f;
+    }
+
+    audible.levelDetector.setState(audibleDetector.state);
+    shadow.levelDetector.setState(shadowDetector.state);
+    audible.maxGainReduction = audibleStats.maxGainReduction;
+    shadow.maxGainReduction = shadowStats.maxGainReduction;
+}
+
+void Compressor::compressLane(juce::AudioBuffer<float>& block, int numSamples, int numChannels, bool isRMSmode, LaneStatistics& stats)
+{
+    if (isRMSmode) applyRMSCompression(block, numSamples, numChannels, true);
+    else           applyPeakCompression(block, numSamples, numChannels, true);
+
+    stats = {};
+    stats.numSamples = numSamples;
+    stats.maxGainReduction = maxGainReduction;
+
+    const float* gainReduction = gainReductionSignal.getReadPointer(0);
+    for (int i = 0; i < numSamples; ++i)
+        stats.sumGainReduction += juce::Decibels::gainToDecibels(gainReduction[i]);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        const float rms = block.getRMSLevel(ch, 0, numSamples);
+        stats.sumOutputSquares += static_cast<double>(rms) * rms * numSamples;
     }
 }
 
 // called directly from MetricsExtractionEngine in order to track the gain reduction signal for offline analysis
 void Compressor::applyPeakCompression(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, bool trackGR)
 {
-    setSidechainSignal(buffer, numSamples);
+    pullParameters(true);
 
-    // Compute attenuation - converts side-chain signal from linear to logarithmic domain
-    gainComputer.applyCompressionToBuffer(rawSidechainSignal, numSamples); // Gain computer stage
-    
-    // Use smoothig detector filter for gain reduction - still logarithmic
-    levelDetector.applyPeakDetector(rawSidechainSignal, numSamples); // Peak-based level detection stage 
+    if (lookaheadSamples > 0) {
+        applyCompressionWithLookahead<PeakDetectorPolicy>(buffer, numSamples, numChannels, trackGR);
+        return;
+    }
+
+    compressPeak(buffer, numSamples, numChannels, linkSidechain(buffer, numSamples, numChannels, false), trackGR);
+}
+
+void Compressor::compressPeak(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, const float* linkedSidechain, bool trackGR)
+{
+    if (isSmoothingParameters()) {
+        applyCompressionSmoothed<PeakDetectorPolicy>(buffer, numSamples, numChannels, linkedSidechain, trackGR);
+        return;
+    }
+
+    if (applyQuietBlock<PeakDetectorPolicy>(buffer, numSamples, numChannels, linkedSidechain, trackGR))
+        return;
+
+    if (processingMode == ProcessingMode::Fused) {
+        applyCompressionFused<PeakDetectorPolicy>(buffer, numSamples, numChannels, linkedSidechain, trackGR);
+        return;
+    }
+
+    setSidechainSignal(buffer, numSamples, linkedSidechain);
+
+    {
+        BlockProfiler::ScopedStage stage(activeProfiler, BlockProfiler::Detector);
+
+        // Compute attenuation - converts side-chain signal from linear to logarithmic domain
+        gainComputer.applyCompressionToBuffer(rawSidechainSignal, numSamples); // Gain computer stage
+
+        // Use smoothig detector filter for gain reduction - still logarithmic
+        levelDetector.applyPeakDetector(rawSidechainSignal, numSamples); // Peak-based level detection stage 
+    }
 
     if (trackGR) { // for metrics extraction
         saveGainReductionSignal(numSamples, numChannels);
@@ -148,13 +604,42 @@ void Compressor::applyPeakCompression(juce::AudioBuffer<float>& buffer, int numS
 // called directly from MetricsExtractionEngine in order to track the gain reduction signal for offline analysis
 void Compressor::applyRMSCompression(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, bool trackGR)
 {
-    setSidechainSignal(buffer, numSamples);
+    pullParameters(true);
+
+    if (lookaheadSamples > 0) {
+        applyCompressionWithLookahead<RMSDetectorPolicy>(buffer, numSamples, numChannels, trackGR);
+        return;
+    }
+
+    compressRMS(buffer, numSamples, numChannels, linkSidechain(buffer, numSamples, numChannels, false), trackGR);
+}
+
+void Compressor::compressRMS(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, const float* linkedSidechain, bool trackGR)
+{
+    if (isSmoothingParameters()) {
+        applyCompressionSmoothed<RMSDetectorPolicy>(buffer, numSamples, numChannels, linkedSidechain, trackGR);
+        return;
+    }
+
+    if (applyQuietBlock<RMSDetectorPolicy>(buffer, numSamples, numChannels, linkedSidechain, trackGR))
+        return;
+
+    if (processingMode == ProcessingMode::Fused) {
+        applyCompressionFused<RMSDetectorPolicy>(buffer, numSamples, numChannels, linkedSidechain, trackGR);
+        return;
+    }
+
+    setSidechainSignal(buffer, numSamples, linkedSidechain);
     
-    // Use smoothig detector filter for rms level computation in linear domain (before log conversion)
-    levelDetector.applyRMSDetector(rawSidechainSignal, numSamples); // RMS-based level detection stage
+    {
+        BlockProfiler::ScopedStage stage(activeProfiler, BlockProfiler::Detector);
+
+        // Use smoothig detector filter for rms level computation in linear domain (before log conversion)
+        levelDetector.applyRMSDetector(rawSidechainSignal, numSamples); // RMS-based level detection stage
 
-    // Compute attenuation - converts side-chain signal from linear to logarithmic domain
-    gainComputer.applyCompressionToBuffer(rawSidechainSignal, numSamples); // Gain computer stage
+        // Compute attenuation - converts side-chain signal from linear to logarithmic domain
+        gainComputer.applyCompressionToBuffer(rawSidechainSignal, numSamples); // Gain computer stage
+    }
 
     if (trackGR) { // for metrics extraction
         saveGainReductionSignal(numSamples, numChannels);
@@ -163,22 +648,345 @@ void Compressor::applyRMSCompression(juce::AudioBuffer<float>& buffer, int numSa
     applyCompressionToInputSignal(buffer, numSamples, numChannels, getMakeup());
 }
 
+// SINGLE-PASS (FUSED) COMPRESSION
+//==============================================================================
+template <typename DetectorPolicy>
+void Compressor::applyCompressionFused(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels,
+    const float* linkedSidechain, bool trackGR)
+{
+    BlockProfiler::ScopedStage stage(activeProfiler, BlockProfiler::Detector);
+    float* grOut = nullptr;
+    if (trackGR) { // for metrics extraction
+        gainReductionSignal.setSize(numChannels, numSamples, false, true, true);
+        grOut = gainReductionSignal.getWritePointer(0);
+    }
+
+    // Detector state is kept in registers for the whole block and written back afterwards
+    DetectorState detector{ levelDetector.getState(), levelDetector.getAlphaAttack(), levelDetector.getAlphaRelease() };
+    float* const* channels = buffer.getArrayOfWritePointers();
+
+    // At control rate the detector runs once every controlInterval samples, with the same time constants
+    if (controlInterval > 1)
+    {
+        // Recomputed only when the time constants or the control rate change
+        if (decimated.alphaAttack != detector.alphaAttack || decimated.alphaRelease != detector.alphaRelease
+            || decimated.interval != controlInterval)
+        {
+            decimated.alphaAttack = detector.alphaAttack;
+            decimated.alphaRelease = detector.alphaRelease;
+            decimated.interval = controlInterval;
+            decimated.decimatedAttack = std::pow(detector.alphaAttack, controlInterval);
+            decimated.decimatedRelease = std::pow(detector.alphaRelease, controlInterval);
+        }
+
+        detector.alphaAttack = decimated.decimatedAttack;
+        detector.alphaRelease = decimated.decimatedRelease;
+    }
+
+    // The topology is fixed at compile time; only the math mode is selected here, once per block
+    switch (gainComputer.getActiveMathMode())
+    {
+    case GainComputer::MathMode::Fast:
+        maxGainReduction = runKernel<DetectorPolicy, FastKnee>(channels, numChannels, numSamples, linkedSidechain, detector, gainComputer.getKneeCurve(), grOut);
+        break;
+    case GainComputer::MathMode::DecibelTable:
+        maxGainReduction = runKernel<DetectorPolicy, DecibelTableKnee>(channels, numChannels, numSamples, linkedSidechain, detector, gainComputer.getCurveTable(), grOut);
+        break;
+    case GainComputer::MathMode::LevelTable:
+        maxGainReduction = runKernel<DetectorPolicy, LevelTableKnee>(channels, numChannels, numSamples, linkedSidechain, detector, gainComputer.getCurveTable(), grOut);
+        break;
+    default:
+        maxGainReduction = runKernel<DetectorPolicy, ExactKnee>(channels, numChannels, numSamples, linkedSidechain, detector, gainComputer.getKneeCurve(), grOut);
+        break;
+    }
+
+    levelDetector.setState(detector.state);
+
+    for (int ch = 1; grOut != nullptr && ch < numChannels; ++ch)
+        gainReductionSignal.copyFrom(ch, 0, gainReductionSignal, 0, 0, numSamples);
+}
+
+template <typename DetectorPolicy, typename KneePolicy>
+float Compressor::runKernel(float* const* channels, int numChannels, int numSamples, const float* linkedSidechain, DetectorState& detector,
+    const typename KneePolicy::Curve& curve, float* grOut)
+{
+    using Kernel = CompressorKernel<DetectorPolicy, KneePolicy>;
+
+    if (controlInterval > 1)
+        return Kernel::processControlRate(channels, numChannels, numSamples, linkedSidechain, controlInterval, detector, curve,
+            makeup, controlRateGain, controlRateGainReduction, grOut);
+
+    return Kernel::process(channels, numChannels, numSamples, linkedSidechain, detector, curve, makeup, grOut);
+}
+
+// SMOOTHED PARAMETER CHANGES
+//==============================================================================
+template <typename DetectorPolicy>
+void Compressor::applyCompressionSmoothed(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels,
+    const float* linkedSidechain, bool trackGR)
+{
+    BlockProfiler::ScopedStage stage(activeProfiler, BlockProfiler::Detector);
+    numProcessedBlocks.fetch_add(1, std::memory_order_relaxed);
+
+    float* grOut = nullptr;
+    if (trackGR) { // for metrics extraction
+        gainReductionSignal.setSize(numChannels, numSamples, false, true, true);
+        grOut = gainReductionSignal.getWritePointer(0);
+    }
+
+    DetectorState detector{ levelDetector.getState(), levelDetector.getAlphaAttack(), levelDetector.getAlphaRelease() };
+    FastMath::KneeCurve curve = gainComputer.getKneeCurve();
+    float* const* channels = buffer.getArrayOfWritePointers();
+    const int right = numChannels > 1 ? 1 : 0;
+
+    float minGainReduction = 0.0f;
+    float gain = 1.0f;
+    float gainReduction = 1.0f;
+
+    auto processSamples = [&](auto knee)
+    {
+        using KneePolicy = decltype(knee);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            curve.threshold = smoothedThreshold.getNextValue();
+            curve.slope = 1.0f / smoothedRatio.getNextValue() - 1.0f;
+            const float currentMakeup = smoothedMakeup.getNextValue();
+
+            const float level = linkedSidechain != nullptr
+                ? linkedSidechain[i]
+                : std::max(std::abs(channels[0][i]), std::abs(channels[right][i]));
+
+            const float gainReductionInDb = CompressorKernel<DetectorPolicy, KneePolicy>::computeGainReduction(detector, curve, level);
+            minGainReduction = std::min(minGainReduction, gainReductionInDb);
+
+            gainReduction = KneePolicy::toGain(gainReductionInDb);
+            if (grOut != nullptr)
+                grOut[i] = gainReduction;
+
+            gain = KneePolicy::toGain(gainReductionInDb + currentMakeup);
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch][i] *= gain;
+        }
+    };
+
+    if (gainComputer.getMathMode() == GainComputer::MathMode::Fast)
+        processSamples(FastKnee{});
+    else
+        processSamples(ExactKnee{});
+
+    levelDetector.setState(detector.state);
+    applySmoothedParameters();
+    maxGainReduction = minGainReduction;
+
+    // Control rate interpolation continues from the last sample
+    controlRateGain = gain;
+    controlRateGainReduction = gainReduction;
+
+    for (int ch = 1; grOut != nullptr && ch < numChannels; ++ch)
+        gainReductionSignal.copyFrom(ch, 0, gainReductionSignal, 0, 0, numSamples);
+}
+
+// LOOKAHEAD
+//==============================================================================
+template <typename DetectorPolicy>
+void Compressor::applyCompressionWithLookahead(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, bool trackGR)
+{
+    jassert(numSamples <= static_cast<int>(lookaheadGain.size()));
+    jassert(numChannels <= delayLine.getNumChannels());
+
+    // The sidechain is computed from the incoming samples ...
+    const float* linkedSidechain = linkSidechain(buffer, numSamples, numChannels, true);
+
+    // ... and the compressor runs on a single channel of ones, which leaves the gain in it
+    float* gain = lookaheadGain.data();
+    juce::FloatVectorOperations::fill(gain, 1.0f, numSamples);
+    juce::AudioBuffer<float> gainBlock(&gain, 1, numSamples);
+
+    if constexpr (DetectorPolicy::smoothsGainReduction)
+        compressPeak(gainBlock, numSamples, 1, linkedSidechain, trackGR);
+    else
+        compressRMS(gainBlock, numSamples, 1, linkedSidechain, trackGR);
+
+    // ... while the gain is applied to the delayed samples
+    delayAndApplyGain(buffer, numSamples, std::min(numChannels, delayLine.getNumChannels()), gain);
+
+    if (trackGR) { // for metrics extraction, same gain reduction on every channel
+        juce::FloatVectorOperations::copy(sidechainRight.data(), gainReductionSignal.getReadPointer(0), numSamples);
+        gainReductionSignal.setSize(numChannels, numSamples, false, false, true);
+        for (int ch = 0; ch < numChannels; ++ch)
+            gainReductionSignal.copyFrom(ch, 0, sidechainRight.data(), numSamples);
+    }
+}
+
+void Compressor::delayAndApplyGain(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, const float* gain)
+{
+    BlockProfiler::ScopedStage stage(activeProfiler, BlockProfiler::GainApplication);
+    const int size = delayLine.getNumSamples();
+    const int readPosition = (delayWritePosition - lookaheadSamples) & (size - 1);
+
+    writeDelayLine(buffer.getArrayOfReadPointers(), numChannels, 0, numSamples);
+
+    // The read range wraps around the end of the ring at most once
+    const int readFirst = std::min(numSamples, size - readPosition);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        float* io = buffer.getWritePointer(ch);
+        const float* ring = delayLine.getReadPointer(ch);
+
+        juce::FloatVectorOperations::multiply(io, ring + readPosition, gain, readFirst);
+        juce::FloatVectorOperations::multiply(io + readFirst, ring, gain + readFirst, numSamples - readFirst);
+    }
+}
+
+void Compressor::writeDelayLine(const float* const* channels, int numChannels, int startSample, int numSamples)
+{
+    const int size = delayLine.getNumSamples();
+
+    // The written range wraps around the end of the ring at most once
+    const int writeFirst = std::min(numSamples, size - delayWritePosition);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        const float* in = channels[ch] + startSample;
+        float* ring = delayLine.getWritePointer(ch);
+
+        juce::FloatVectorOperations::copy(ring + delayWritePosition, in, writeFirst);
+        juce::FloatVectorOperations::copy(ring, in + writeFirst, numSamples - writeFirst);
+    }
+
+    delayWritePosition = (delayWritePosition + numSamples) & (size - 1);
+}
+
+void Compressor::delayUnprocessed(juce::AudioBuffer<float>& buffer)
+{
+    if (lookaheadSamples == 0)
+        return;
+
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = std::min(buffer.getNumChannels(), delayLine.getNumChannels());
+    float* const* channels = buffer.getArrayOfWritePointers();
+
+    float* gain = lookaheadGain.data();
+    juce::FloatVectorOperations::fill(gain, 1.0f, std::min(subBlockSize, numSamples));
+
+    for (int start = 0; start < numSamples; start += subBlockSize) {
+        const int n = std::min(subBlockSize, numSamples - start);
+        juce::AudioBuffer<float> subBlock(channels, numChannels, start, n);
+        delayAndApplyGain(subBlock, n, numChannels, gain);
+    }
+}
+
+void Compressor::writeLookahead(const juce::AudioBuffer<float>& buffer)
+{
+    latchLookahead();
+
+    if (lookaheadSamples == 0)
+        return;
+
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = std::min(buffer.getNumChannels(), delayLine.getNumChannels());
+
+    for (int start = 0; start < numSamples; start += subBlockSize)
+        writeDelayLine(buffer.getArrayOfReadPointers(), numChannels, start, std::min(subBlockSize, numSamples - start));
+}
+
+// QUIET-BLOCK FAST PATH
+//==============================================================================
+template <typename DetectorPolicy>
+bool Compressor::applyQuietBlock(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels,
+    const float* linkedSidechain, bool trackGR)
+{
+    BlockProfiler::ScopedStage stage(activeProfiler, BlockProfiler::Detector);
+    numProcessedBlocks.fetch_add(1, std::memory_order_relaxed);
+
+    // The reference path stays the untouched baseline the optimized modes are compared with
+    if (!quietBlockFastPath || processingMode == ProcessingMode::Reference)
+        return false;
+
+    const int numLinkedChannels = std::min(numChannels, 2);
+    float blockPeak = 0.0f;
+    if (linkedSidechain != nullptr) {
+        blockPeak = juce::FloatVectorOperations::findMaximum(linkedSidechain, numSamples);
+    } else {
+        for (int ch = 0; ch < numLinkedChannels; ++ch)
+            blockPeak = std::max(blockPeak, buffer.getMagnitude(ch, 0, numSamples));
+    }
+
+    const FastMath::KneeCurve curve = gainComputer.getKneeCurve();
+    const float kneeStart = curve.threshold - curve.kneeHalf - quietBlockMarginDb;
+
+    DetectorState detector{ levelDetector.getState(), levelDetector.getAlphaAttack(), levelDetector.getAlphaRelease() };
+
+    if constexpr (DetectorPolicy::smoothsGainReduction)
+    {
+        if (detector.state < -quietStateThresholdDb
+            || juce::Decibels::gainToDecibels(std::max(blockPeak, FastMath::minLevel)) > kneeStart)
+            return false;
+
+        // The gain computer outputs 0 dB for every sample of the block
+        for (int i = 0; i < numSamples; ++i)
+            DetectorPolicy::update(detector, 0.0f);
+    }
+    else
+    {
+        // The detector output never exceeds the larger of its state and its input
+        const double largestMeanSquare = std::max(detector.state, static_cast<double>(blockPeak) * blockPeak);
+        const float largestDetectedLevel = std::sqrtf(static_cast<float>(largestMeanSquare)) * (1 / std::sqrtf(2.0f));
+        if (juce::Decibels::gainToDecibels(std::max(largestDetectedLevel, FastMath::minLevel)) > kneeStart)
+            return false;
+
+        const float* left = buffer.getReadPointer(0);
+        const float* right = buffer.getReadPointer(numLinkedChannels - 1);
+        for (int i = 0; i < numSamples; ++i)
+            DetectorPolicy::update(detector, linkedSidechain != nullptr
+                ? linkedSidechain[i]
+                : std::max(std::abs(left[i]), std::abs(right[i])));
+    }
+
+    levelDetector.setState(detector.state);
+
+    const float makeupGain = gainComputer.getMathMode() == GainComputer::MathMode::Fast
+        ? FastMath::decibelsToGain(makeup)
+        : juce::Decibels::decibelsToGain(makeup);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        juce::FloatVectorOperations::multiply(buffer.getWritePointer(ch), makeupGain, numSamples);
+
+    if (trackGR) { // for metrics extraction
+        gainReductionSignal.setSize(numChannels, numSamples, false, true, true);
+        for (int ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::fill(gainReductionSignal.getWritePointer(ch), 1.0f, numSamples);
+    }
+
+    // Control rate interpolation continues from the makeup gain
+    controlRateGain = makeupGain;
+    controlRateGainReduction = 1.0f;
+
+    maxGainReduction = 0.0f;
+    numQuietBlocks.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
 // AUDIO BUFFERS HANDLING FOR COMPRESSION AND LOG->LIN CONVERTER
 //==============================================================================
-void Compressor::setSidechainSignal(juce::AudioBuffer<float>& buffer, int numSamples)
+void Compressor::setSidechainSignal(juce::AudioBuffer<float>& buffer, int numSamples, const float* linkedSidechain)
 {
+    BlockProfiler::ScopedStage stage(activeProfiler, BlockProfiler::Sidechain);
     // Clear any old samples
-    originalSignal.clear();
     juce::FloatVectorOperations::fill(rawSidechainSignal, 0.0f, numSamples);
     maxGainReduction = 0.0f;
 
-    // Ensure the temp buffer exists
-    if ((int) sidechainRight.size() < numSamples)
-        sidechainRight.resize((size_t)numSamples);
+    if (linkedSidechain != nullptr) {
+        juce::FloatVectorOperations::copy(rawSidechainSignal, linkedSidechain, numSamples);
+        return;
+    }
+
+    // Scratch memory is allocated in prepare()
+    jassert(numSamples <= static_cast<int>(sidechainRight.size()));
 
-    // Get absolute values of both left and right channel
+    // Get absolute values of both left and right channel (a mono signal is linked with itself)
     juce::FloatVectorOperations::abs(rawSidechainSignal, buffer.getReadPointer(0), numSamples);
-    juce::FloatVectorOperations::abs(sidechainRight.data(), buffer.getReadPointer(1), numSamples);
+    juce::FloatVectorOperations::abs(sidechainRight.data(), buffer.getReadPointer(buffer.getNumChannels() > 1 ? 1 : 0), numSamples);
 
     // The gain reduction is based on the larger amplitude across the two channels
     juce::FloatVectorOperations::max(rawSidechainSignal,
@@ -187,25 +995,70 @@ void Compressor::setSidechainSignal(juce::AudioBuffer<float>& buffer, int numSam
         numSamples);
 }
 
+const float* Compressor::linkSidechain(const juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, bool forceSeparatePass)
+{
+    BlockProfiler::ScopedStage stage(activeProfiler, BlockProfiler::Sidechain);
+    // Stereo (and mono) max link is done inside the kernels, without a separate pass
+    if (channelLink == ChannelLink::Max && numChannels <= 2 && !forceSeparatePass)
+        return nullptr;
+
+    // Scratch memory is allocated in prepare()
+    jassert(numSamples <= static_cast<int>(linkedSidechainSignal.size()));
+
+    float* linked = linkedSidechainSignal.data();
+    float* scratch = sidechainRight.data();
+
+    switch (channelLink)
+    {
+    case ChannelLink::Max:
+        juce::FloatVectorOperations::abs(linked, buffer.getReadPointer(0), numSamples);
+        for (int ch = 1; ch < numChannels; ++ch) {
+            juce::FloatVectorOperations::abs(scratch, buffer.getReadPointer(ch), numSamples);
+            juce::FloatVectorOperations::max(linked, linked, scratch, numSamples);
+        }
+        break;
+
+    case ChannelLink::Sum:
+        juce::FloatVectorOperations::abs(linked, buffer.getReadPointer(0), numSamples);
+        for (int ch = 1; ch < numChannels; ++ch) {
+            juce::FloatVectorOperations::abs(scratch, buffer.getReadPointer(ch), numSamples);
+            juce::FloatVectorOperations::add(linked, scratch, numSamples);
+        }
+        break;
+
+    case ChannelLink::RMS:
+        juce::FloatVectorOperations::multiply(linked, buffer.getReadPointer(0), buffer.getReadPointer(0), numSamples);
+        for (int ch = 1; ch < numChannels; ++ch) {
+            juce::FloatVectorOperations::multiply(scratch, buffer.getReadPointer(ch), buffer.getReadPointer(ch), numSamples);
+            juce::FloatVectorOperations::add(linked, scratch, numSamples);
+        }
+        juce::FloatVectorOperations::multiply(linked, 1.0f / static_cast<float>(numChannels), numSamples);
+        for (int i = 0; i < numSamples; ++i)
+            linked[i] = std::sqrt(linked[i]);
+        break;
+    }
+
+    return linked;
+}
 
 void Compressor::applyCompressionToInputSignal(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, float makeup)
 {
+    BlockProfiler::ScopedStage stage(activeProfiler, BlockProfiler::GainApplication);
     // Get minimum = max. gain reduction from side chain buffer, for gain reduction metering
     maxGainReduction = juce::FloatVectorOperations::findMinimum(rawSidechainSignal, numSamples);
 
     // Add makeup gain and convert side-chain to linear domain
-    for (int i = 0; i < numSamples; ++i) {
-        sidechainSignal[i] = juce::Decibels::decibelsToGain(sidechainSignal[i] + makeup);
-    }
-
-    // Copy buffer to original signal
-    for (int i = 0; i < numChannels; ++i) {
-        originalSignal.copyFrom(i, 0, buffer, i, 0, numSamples);
+    if (gainComputer.getMathMode() == GainComputer::MathMode::Fast) {
+        FastMath::decibelsToGain(rawSidechainSignal, numSamples, makeup);
+    } else {
+        for (int i = 0; i < numSamples; ++i) {
+            sidechainSignal[i] = juce::Decibels::decibelsToGain(sidechainSignal[i] + makeup);
+        }
     }
 
     // Multiply attenuation with buffer - apply compression
     for (int i = 0; i < numChannels; ++i) {
-        juce::FloatVectorOperations::multiply(buffer.getWritePointer(i), rawSidechainSignal, buffer.getNumSamples());
+        juce::FloatVectorOperations::multiply(buffer.getWritePointer(i), rawSidechainSignal, numSamples);
     }
 }
 
@@ -214,22 +1067,44 @@ void Compressor::applyCompressionToInputSignal(juce::AudioBuffer<float>& buffer,
 //==============================================================================
 void Compressor::saveGainReductionSignal(int numSamples, int numChannels)
 {
+    // Preallocated in prepare(), the gain reduction is converted once and copied to the other channels
     gainReductionSignal.setSize(numChannels, numSamples, false, true, true);
-    for (int channel = 0; channel < numChannels; ++channel) {
-        for (int sample = 0; sample < numSamples; sample++) {
-            gainReductionSignal.setSample(channel, sample, juce::Decibels::decibelsToGain(rawSidechainSignal[sample]));
-        }
+    float* gainReduction = gainReductionSignal.getWritePointer(0);
+    for (int sample = 0; sample < numSamples; ++sample)
+        gainReduction[sample] = juce::Decibels::decibelsToGain(rawSidechainSignal[sample]);
+
+    for (int channel = 1; channel < numChannels; ++channel)
+        gainReductionSignal.copyFrom(channel, 0, gainReductionSignal, 0, 0, numSamples);
+}
+
+void Compressor::copyParametersFrom(const Compressor& other)
+{
+    // The latest parameters, applied without smoothing (coefficients are recomputed in prepare).
+    // The gain computer and detector state are derived from them, the other compressor's audio
+    // thread may be writing its own.
+    Parameters parameters;
+    {
+        const juce::SpinLock::ScopedLockType lock(other.parameterWriteLock);
+        parameters = other.pendingParameters;
     }
+    updateParameters([&parameters](Parameters& p) { p = parameters; });
+    pullParameters(false);
+
+    setMathMode(other.getMathMode());
+    processingMode = other.processingMode;
+    controlInterval = other.controlInterval;
+    controlRateGain = -1.0f;
+    quietBlockFastPath = other.quietBlockFastPath;
+    channelLink = other.channelLink;
+    lookaheadMs = other.lookaheadMs.load();
+    updateTargetLookaheadSamples();
+    bypassed = other.bypassed;
 }
 
 // This is called from MetricsExtractionEngine when the compressor operates on a loaded audio file
 void Compressor::prepareForMetricsExtraction(const juce::dsp::ProcessSpec& audioFilePs)
 {
-    levelDetector.prepare(audioFilePs.sampleRate);
-    originalSignal.setSize(2, audioFilePs.maximumBlockSize);
-    sidechainSignal.resize(audioFilePs.maximumBlockSize, 0.0f);
-    rawSidechainSignal = sidechainSignal.data();
-    originalSignal.clear();
+    prepareBuffers(audioFilePs);
 }
 
 // This gets called from MetricsExtractionEngine when the extraction
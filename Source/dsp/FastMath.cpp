@@ -0,0 +1,435 @@
+/*
+ * This file implements the vectorized kernels declared in FastMath.h.
+ *
+ * This file handles:
+ * - AVX2 + FMA kernels (8 floats), selected when the host CPU supports them.
+ * - SSE2 kernels (4 floats), the baseline on x86/x64.
+ * - NEON kernels (4 floats) on ARM.
+ * - Scalar fallback and remainder handling, using the same approximations.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/FastMath.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define FASTMATH_X86 1
+ #include <immintrin.h>
+ #if defined(__GNUC__) || defined(__clang__)
+  #define FASTMATH_AVX2_TARGET __attribute__((target("avx2,fma")))
+ #else
+  #define FASTMATH_AVX2_TARGET
+ #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+ #define FASTMATH_NEON 1
+ #include <arm_neon.h>
+#endif
+
+namespace FastMath
+{
+namespace
+{
+    // Scalar kernels, also used for the remainder of the vector loops
+    //==============================================================================
+    void levelsToGainReductionScalar(float* data, int numSamples, const KneeCurve& curve)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float level = std::max(std::abs(data[i]), minLevel);
+            data[i] = applyKneeCurve(gainToDecibels(level), curve);
+        }
+    }
+
+    void decibelsToGainScalar(float* data, int numSamples, float offsetDb)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = decibelsToGain(data[i] + offsetDb);
+    }
+
+    void gainToDecibelsScalar(const float* gains, float* decibels, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            decibels[i] = gainToDecibels(gains[i]);
+    }
+
+#if FASTMATH_X86
+    // SSE2
+    //==============================================================================
+    inline __m128 log2Sse(__m128 x)
+    {
+        const __m128i bits = _mm_castps_si128(x);
+        const __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+        const __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                                              _mm_set1_epi32(0x3f800000)));
+        const __m128 t = _mm_sub_ps(mantissa, _mm_set1_ps(1.0f));
+
+        __m128 p = _mm_set1_ps(log2C5);
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(log2C4));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(log2C3));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(log2C2));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(log2C1));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(log2C0));
+        return _mm_add_ps(exponent, _mm_mul_ps(t, p));
+    }
+
+    inline __m128 exp2Sse(__m128 x)
+    {
+        x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+
+        // floor() without SSE4.1: truncate, then correct negative non-integers
+        __m128i integerPart = _mm_cvttps_epi32(x);
+        const __m128 truncated = _mm_cvtepi32_ps(integerPart);
+        const __m128i needsCorrection = _mm_castps_si128(_mm_cmpgt_ps(truncated, x));
+        integerPart = _mm_add_epi32(integerPart, needsCorrection); // mask is -1 where truncated > x
+        const __m128 f = _mm_sub_ps(x, _mm_cvtepi32_ps(integerPart));
+
+        __m128 p = _mm_set1_ps(exp2C5);
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(exp2C4));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(exp2C3));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(exp2C2));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(exp2C1));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f));
+
+        const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(integerPart, _mm_set1_epi32(127)), 23));
+        return _mm_mul_ps(p, scale);
+    }
+
+    void levelsToGainReductionSse(float* data, int numSamples, const KneeCurve& curve)
+    {
+        const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        const __m128 minLevelV = _mm_set1_ps(minLevel);
+        const __m128 minusInfV = _mm_set1_ps(minusInfinityDb);
+        const __m128 dbPerLog2 = _mm_set1_ps(decibelsPerLog2);
+        const __m128 threshold = _mm_set1_ps(curve.threshold);
+        const __m128 knee = _mm_set1_ps(curve.knee);
+        const __m128 kneeHalf = _mm_set1_ps(curve.kneeHalf);
+        const __m128 invTwoKnee = _mm_set1_ps(curve.invTwoKnee);
+        const __m128 slope = _mm_set1_ps(curve.slope);
+        const __m128 zero = _mm_setzero_ps();
+
+        int i = 0;
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const __m128 level = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(data + i), signMask), minLevelV);
+            const __m128 levelInDb = _mm_max_ps(_mm_mul_ps(log2Sse(level), dbPerLog2), minusInfV);
+
+            const __m128 overshoot = _mm_sub_ps(levelInDb, threshold);
+            const __m128 t = _mm_min_ps(_mm_max_ps(_mm_add_ps(overshoot, kneeHalf), zero), knee);
+            const __m128 linear = _mm_max_ps(_mm_sub_ps(overshoot, kneeHalf), zero);
+            const __m128 gr = _mm_mul_ps(slope, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(t, t), invTwoKnee), linear));
+
+            _mm_storeu_ps(data + i, gr);
+        }
+
+        levelsToGainReductionScalar(data + i, numSamples - i, curve);
+    }
+
+    void decibelsToGainSse(float* data, int numSamples, float offsetDb)
+    {
+        const __m128 offset = _mm_set1_ps(offsetDb);
+        const __m128 minusInfV = _mm_set1_ps(minusInfinityDb);
+        const __m128 log2PerDb = _mm_set1_ps(log2PerDecibel);
+
+        int i = 0;
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const __m128 db = _mm_add_ps(_mm_loadu_ps(data + i), offset);
+            const __m128 gain = exp2Sse(_mm_mul_ps(db, log2PerDb));
+            _mm_storeu_ps(data + i, _mm_and_ps(gain, _mm_cmpgt_ps(db, minusInfV))); // -100 dB and below => 0
+        }
+
+        decibelsToGainScalar(data + i, numSamples - i, offsetDb);
+    }
+
+    void gainToDecibelsSse(const float* gains, float* decibels, int numSamples)
+    {
+        const __m128 minusInfV = _mm_set1_ps(minusInfinityDb);
+        const __m128 dbPerLog2 = _mm_set1_ps(decibelsPerLog2);
+        const __m128 zero = _mm_setzero_ps();
+
+        int i = 0;
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const __m128 gain = _mm_loadu_ps(gains + i);
+            const __m128 db = _mm_max_ps(_mm_mul_ps(log2Sse(gain), dbPerLog2), minusInfV);
+            const __m128 positive = _mm_cmpgt_ps(gain, zero);
+            _mm_storeu_ps(decibels + i, _mm_or_ps(_mm_and_ps(positive, db), _mm_andnot_ps(positive, minusInfV)));
+        }
+
+        gainToDecibelsScalar(gains + i, decibels + i, numSamples - i);
+    }
+
+    // AVX2 + FMA
+    //==============================================================================
+    FASTMATH_AVX2_TARGET inline __m256 log2Avx2(__m256 x)
+    {
+        const __m256i bits = _mm256_castps_si256(x);
+        const __m256 exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+        const __m256 mantissa = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                                    _mm256_set1_epi32(0x3f800000)));
+        const __m256 t = _mm256_sub_ps(mantissa, _mm256_set1_ps(1.0f));
+
+        __m256 p = _mm256_set1_ps(log2C5);
+        p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(log2C4));
+        p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(log2C3));
+        p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(log2C2));
+        p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(log2C1));
+        p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(log2C0));
+        return _mm256_fmadd_ps(t, p, exponent);
+    }
+
+    FASTMATH_AVX2_TARGET inline __m256 exp2Avx2(__m256 x)
+    {
+        x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-126.0f)), _mm256_set1_ps(127.0f));
+
+        const __m256 integerPart = _mm256_floor_ps(x);
+        const __m256 f = _mm256_sub_ps(x, integerPart);
+
+        __m256 p = _mm256_set1_ps(exp2C5);
+        p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(exp2C4));
+        p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(exp2C3));
+        p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(exp2C2));
+        p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(exp2C1));
+        p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(1.0f));
+
+        const __m256i exponent = _mm256_add_epi32(_mm256_cvtps_epi32(integerPart), _mm256_set1_epi32(127));
+        return _mm256_mul_ps(p, _mm256_castsi256_ps(_mm256_slli_epi32(exponent, 23)));
+    }
+
+    FASTMATH_AVX2_TARGET void levelsToGainReductionAvx2(float* data, int numSamples, const KneeCurve& curve)
+    {
+        const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+        const __m256 minLevelV = _mm256_set1_ps(minLevel);
+        const __m256 minusInfV = _mm256_set1_ps(minusInfinityDb);
+        const __m256 dbPerLog2 = _mm256_set1_ps(decibelsPerLog2);
+        const __m256 threshold = _mm256_set1_ps(curve.threshold);
+        const __m256 knee = _mm256_set1_ps(curve.knee);
+        const __m256 kneeHalf = _mm256_set1_ps(curve.kneeHalf);
+        const __m256 invTwoKnee = _mm256_set1_ps(curve.invTwoKnee);
+        const __m256 slope = _mm256_set1_ps(curve.slope);
+        const __m256 zero = _mm256_setzero_ps();
+
+        int i = 0;
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const __m256 level = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(data + i), signMask), minLevelV);
+            const __m256 levelInDb = _mm256_max_ps(_mm256_mul_ps(log2Avx2(level), dbPerLog2), minusInfV);
+
+            const __m256 overshoot = _mm256_sub_ps(levelInDb, threshold);
+            const __m256 t = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(overshoot, kneeHalf), zero), knee);
+            const __m256 linear = _mm256_max_ps(_mm256_sub_ps(overshoot, kneeHalf), zero);
+            const __m256 gr = _mm256_mul_ps(slope, _mm256_fmadd_ps(_mm256_mul_ps(t, t), invTwoKnee, linear));
+
+            _mm256_storeu_ps(data + i, gr);
+        }
+
+        levelsToGainReductionScalar(data + i, numSamples - i, curve);
+    }
+
+    FASTMATH_AVX2_TARGET void decibelsToGainAvx2(float* data, int numSamples, float offsetDb)
+    {
+        const __m256 offset = _mm256_set1_ps(offsetDb);
+        const __m256 minusInfV = _mm256_set1_ps(minusInfinityDb);
+        const __m256 log2PerDb = _mm256_set1_ps(log2PerDecibel);
+
+        int i = 0;
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const __m256 db = _mm256_add_ps(_mm256_loadu_ps(data + i), offset);
+            const __m256 gain = exp2Avx2(_mm256_mul_ps(db, log2PerDb));
+            _mm256_storeu_ps(data + i, _mm256_and_ps(gain, _mm256_cmp_ps(db, minusInfV, _CMP_GT_OQ)));
+        }
+
+        decibelsToGainScalar(data + i, numSamples - i, offsetDb);
+    }
+
+    FASTMATH_AVX2_TARGET void gainToDecibelsAvx2(const float* gains, float* decibels, int numSamples)
+    {
+        const __m256 minusInfV = _mm256_set1_ps(minusInfinityDb);
+        const __m256 dbPerLog2 = _mm256_set1_ps(decibelsPerLog2);
+        const __m256 zero = _mm256_setzero_ps();
+
+        int i = 0;
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const __m256 gain = _mm256_loadu_ps(gains + i);
+            const __m256 db = _mm256_max_ps(_mm256_mul_ps(log2Avx2(gain), dbPerLog2), minusInfV);
+            _mm256_storeu_ps(decibels + i, _mm256_blendv_ps(minusInfV, db, _mm256_cmp_ps(gain, zero, _CMP_GT_OQ)));
+        }
+
+        gainToDecibelsScalar(gains + i, decibels + i, numSamples - i);
+    }
+#endif
+
+#if FASTMATH_NEON
+    // NEON
+    //==============================================================================
+    inline float32x4_t log2Neon(float32x4_t x)
+    {
+        const int32x4_t bits = vreinterpretq_s32_f32(x);
+        const float32x4_t exponent = vcvtq_f32_s32(vsubq_s32(vshrq_n_s32(bits, 23), vdupq_n_s32(127)));
+        const float32x4_t mantissa = vreinterpretq_f32_s32(vorrq_s32(vandq_s32(bits, vdupq_n_s32(0x007fffff)),
+                                                                     vdupq_n_s32(0x3f800000)));
+        const float32x4_t t = vsubq_f32(mantissa, vdupq_n_f32(1.0f));
+
+        float32x4_t p = vdupq_n_f32(log2C5);
+        p = vmlaq_f32(vdupq_n_f32(log2C4), p, t);
+        p = vmlaq_f32(vdupq_n_f32(log2C3), p, t);
+        p = vmlaq_f32(vdupq_n_f32(log2C2), p, t);
+        p = vmlaq_f32(vdupq_n_f32(log2C1), p, t);
+        p = vmlaq_f32(vdupq_n_f32(log2C0), p, t);
+        return vmlaq_f32(exponent, t, p);
+    }
+
+    inline float32x4_t exp2Neon(float32x4_t x)
+    {
+        x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-126.0f)), vdupq_n_f32(127.0f));
+
+        // floor(): truncate, then correct negative non-integers
+        int32x4_t integerPart = vcvtq_s32_f32(x);
+        const uint32x4_t needsCorrection = vcgtq_f32(vcvtq_f32_s32(integerPart), x);
+        integerPart = vaddq_s32(integerPart, vreinterpretq_s32_u32(needsCorrection)); // mask is -1 where truncated > x
+        const float32x4_t f = vsubq_f32(x, vcvtq_f32_s32(integerPart));
+
+        float32x4_t p = vdupq_n_f32(exp2C5);
+        p = vmlaq_f32(vdupq_n_f32(exp2C4), p, f);
+        p = vmlaq_f32(vdupq_n_f32(exp2C3), p, f);
+        p = vmlaq_f32(vdupq_n_f32(exp2C2), p, f);
+        p = vmlaq_f32(vdupq_n_f32(exp2C1), p, f);
+        p = vmlaq_f32(vdupq_n_f32(1.0f), p, f);
+
+        const int32x4_t scaleBits = vshlq_n_s32(vaddq_s32(integerPart, vdupq_n_s32(127)), 23);
+        return vmulq_f32(p, vreinterpretq_f32_s32(scaleBits));
+    }
+
+    void levelsToGainReductionNeon(float* data, int numSamples, const KneeCurve& curve)
+    {
+        const float32x4_t minLevelV = vdupq_n_f32(minLevel);
+        const float32x4_t minusInfV = vdupq_n_f32(minusInfinityDb);
+        const float32x4_t dbPerLog2 = vdupq_n_f32(decibelsPerLog2);
+        const float32x4_t threshold = vdupq_n_f32(curve.threshold);
+        const float32x4_t knee = vdupq_n_f32(curve.knee);
+        const float32x4_t kneeHalf = vdupq_n_f32(curve.kneeHalf);
+        const float32x4_t invTwoKnee = vdupq_n_f32(curve.invTwoKnee);
+        const float32x4_t slope = vdupq_n_f32(curve.slope);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+
+        int i = 0;
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const float32x4_t level = vmaxq_f32(vabsq_f32(vld1q_f32(data + i)), minLevelV);
+            const float32x4_t levelInDb = vmaxq_f32(vmulq_f32(log2Neon(level), dbPerLog2), minusInfV);
+
+            const float32x4_t overshoot = vsubq_f32(levelInDb, threshold);
+            const float32x4_t t = vminq_f32(vmaxq_f32(vaddq_f32(overshoot, kneeHalf), zero), knee);
+            const float32x4_t linear = vmaxq_f32(vsubq_f32(overshoot, kneeHalf), zero);
+            const float32x4_t gr = vmulq_f32(slope, vmlaq_f32(linear, vmulq_f32(t, t), invTwoKnee));
+
+            vst1q_f32(data + i, gr);
+        }
+
+        levelsToGainReductionScalar(data + i, numSamples - i, curve);
+    }
+
+    void decibelsToGainNeon(float* data, int numSamples, float offsetDb)
+    {
+        const float32x4_t offset = vdupq_n_f32(offsetDb);
+        const float32x4_t minusInfV = vdupq_n_f32(minusInfinityDb);
+        const float32x4_t log2PerDb = vdupq_n_f32(log2PerDecibel);
+
+        int i = 0;
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const float32x4_t db = vaddq_f32(vld1q_f32(data + i), offset);
+            const float32x4_t gain = exp2Neon(vmulq_f32(db, log2PerDb));
+            const uint32x4_t audible = vcgtq_f32(db, minusInfV);
+            vst1q_f32(data + i, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(gain), audible)));
+        }
+
+        decibelsToGainScalar(data + i, numSamples - i, offsetDb);
+    }
+
+    void gainToDecibelsNeon(const float* gains, float* decibels, int numSamples)
+    {
+        const float32x4_t minusInfV = vdupq_n_f32(minusInfinityDb);
+        const float32x4_t dbPerLog2 = vdupq_n_f32(decibelsPerLog2);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+
+        int i = 0;
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const float32x4_t gain = vld1q_f32(gains + i);
+            const float32x4_t db = vmaxq_f32(vmulq_f32(log2Neon(gain), dbPerLog2), minusInfV);
+            vst1q_f32(decibels + i, vbslq_f32(vcgtq_f32(gain, zero), db, minusInfV));
+        }
+
+        gainToDecibelsScalar(gains + i, decibels + i, numSamples - i);
+    }
+#endif
+
+    // Runtime dispatch
+    //==============================================================================
+    struct Kernels
+    {
+        void (*levelsToGainReduction)(float*, int, const KneeCurve&);
+        void (*decibelsToGain)(float*, int, float);
+        void (*gainToDecibels)(const float*, float*, int);
+        const char* name;
+    };
+
+    Kernels selectKernels()
+    {
+#if FASTMATH_X86
+        if (juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3())
+            return { levelsToGainReductionAvx2, decibelsToGainAvx2, gainToDecibelsAvx2, "AVX2" };
+
+        return { levelsToGainReductionSse, decibelsToGainSse, gainToDecibelsSse, "SSE2" };
+#elif FASTMATH_NEON
+        return { levelsToGainReductionNeon, decibelsToGainNeon, gainToDecibelsNeon, "NEON" };
+#else
+        return { levelsToGainReductionScalar, decibelsToGainScalar, gainToDecibelsScalar, "Scalar" };
+#endif
+    }
+
+    const Kernels& getKernels()
+    {
+        static const Kernels kernels = selectKernels();
+        return kernels;
+    }
+}
+
+void levelsToGainReduction(float* data, int numSamples, const KneeCurve& curve)
+{
+    getKernels().levelsToGainReduction(data, numSamples, curve);
+}
+
+void decibelsToGain(float* data, int numSamples, float offsetDb)
+{
+    getKernels().decibelsToGain(data, numSamples, offsetDb);
+}
+
+void gainToDecibels(const float* gains, float* decibels, int numSamples)
+{
+    getKernels().gainToDecibels(gains, decibels, numSamples);
+}
+
+const char* getKernelName()
+{
+    return getKernels().name;
+}
+}
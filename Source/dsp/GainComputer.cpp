@@ -84,8 +84,38 @@ float GainComputer::applyCompression(float& input)
     return slope * overshoot;
 }
 
+float GainComputer::applyCompressionBranchless(float levelInDecibels) const
+{
+    return FastMath::applyKneeCurve(levelInDecibels, getKneeCurve());
+}
+
 void GainComputer::applyCompressionToBuffer(float* src, int numSamples)
 {
+    const MathMode mode = getActiveMathMode();
+
+    if (mode == MathMode::Fast)
+    {
+        // Vectorized lin -> log conversion and static curve in one pass
+        FastMath::levelsToGainReduction(src, numSamples, getKneeCurve());
+        return;
+    }
+
+    if (mode == MathMode::DecibelTable)
+    {
+        const GainCurveTable& table = getCurveTable();
+        for (int i = 0; i < numSamples; ++i)
+            src[i] = table.lookupDecibels(juce::Decibels::gainToDecibels(std::max(abs(src[i]), 1e-6f)));
+        return;
+    }
+
+    if (mode == MathMode::LevelTable)
+    {
+        const GainCurveTable& table = getCurveTable();
+        for (int i = 0; i < numSamples; ++i)
+            src[i] = table.lookupLevel(std::max(abs(src[i]), 1e-6f));
+        return;
+    }
+
     for (int i = 0; i < numSamples; ++i)
     {
         const float level = std::max(abs(src[i]), 1e-6f);
@@ -93,3 +123,50 @@ void GainComputer::applyCompressionToBuffer(float* src, int numSamples)
         src[i] = applyCompression(levelInDecibels);
     }
 }
+
+void GainComputer::setMathMode(MathMode mode)
+{
+    mathMode = mode;
+}
+
+GainComputer::MathMode GainComputer::getMathMode() const
+{
+    return mathMode;
+}
+
+GainComputer::MathMode GainComputer::getActiveMathMode() const
+{
+    if (mathMode != MathMode::DecibelTable && mathMode != MathMode::LevelTable)
+        return mathMode;
+
+    // The table modes need a table from setCurveTable()
+    jassert(curveTable != nullptr);
+
+    // Until the owner has rebuilt the table for the current curve, the exact curve is used
+    if (curveTable == nullptr || !curveTable->matches(getKneeCurve()))
+        return MathMode::Exact;
+
+    return mathMode;
+}
+
+FastMath::KneeCurve GainComputer::getKneeCurve() const
+{
+    FastMath::KneeCurve curve;
+    curve.threshold = threshold;
+    curve.knee = knee;
+    curve.kneeHalf = kneeHalf;
+    curve.invTwoKnee = knee > 0.0f ? 0.5f / knee : 0.0f;
+    curve.slope = slope;
+    return curve;
+}
+
+void GainComputer::setCurveTable(const GainCurveTable* table)
+{
+    curveTable = table;
+}
+
+const GainCurveTable& GainComputer::getCurveTable() const
+{
+    jassert(curveTable != nullptr);
+    return *curveTable;
+}
@@ -0,0 +1,54 @@
+/*
+ * This file implements GainCurveTable, a precomputed version of the threshold/ratio/knee curve.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/GainCurveTable.h"
+
+void GainCurveTable::build(const FastMath::KneeCurve& newCurve)
+{
+    curve = newCurve;
+
+    decibelTable.resize(static_cast<size_t>(decibelTableSize));
+    levelTable.resize(static_cast<size_t>(levelTableSize));
+
+    for (int i = 0; i < decibelTableSize; ++i)
+        decibelTable[i] = evaluate(minDecibels + static_cast<float>(i) / static_cast<float>(stepsPerDecibel));
+
+    // Every entry is the level whose exponent and upper mantissa bits equal the entry index
+    for (int i = 0; i < levelTableSize; ++i)
+    {
+        const uint32_t bits = (minBiasedExponent << 23) + (static_cast<uint32_t>(i) << (23 - mantissaBits));
+        float level;
+        std::memcpy(&level, &bits, sizeof(level));
+        levelTable[i] = evaluate(static_cast<float>(20.0 * std::log10(static_cast<double>(level))));
+    }
+}
+
+float GainCurveTable::evaluate(float levelInDecibels) const
+{
+    // Same branched curve as GainComputer::applyCompression
+    const float overshoot = levelInDecibels - curve.threshold;
+
+    if (overshoot <= -curve.kneeHalf)
+        return 0.0f;
+    if (overshoot > -curve.kneeHalf && overshoot <= curve.kneeHalf)
+        return 0.5f * curve.slope * ((overshoot + curve.kneeHalf) * (overshoot + curve.kneeHalf)) / curve.knee;
+
+    return curve.slope * overshoot;
+}
@@ -0,0 +1,62 @@
+/*
+ * This file implements GainReductionTap, a real-time safe history of the gain reduction.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/GainReductionTap.h"
+
+void GainReductionTap::prepare(int capacity)
+{
+    // AbstractFifo keeps one slot free
+    const int size = juce::nextPowerOfTwo(capacity + 1);
+    if (size == fifo.getTotalSize())
+        return;
+
+    ring.assign(static_cast<size_t>(size), 0.0f);
+    fifo.setTotalSize(size);
+}
+
+void GainReductionTap::push(float gainReductionInDb)
+{
+    // Nothing is written if the reader fell behind by a whole ring
+    const auto scope = fifo.write(1);
+    if (scope.blockSize1 > 0)
+        ring[static_cast<size_t>(scope.startIndex1)] = gainReductionInDb;
+}
+
+int GainReductionTap::pop(float* dest, int maxValues)
+{
+    const auto scope = fifo.read(juce::jmin(maxValues, fifo.getNumReady()));
+
+    if (scope.blockSize1 > 0)
+        std::copy_n(ring.data() + scope.startIndex1, scope.blockSize1, dest);
+    if (scope.blockSize2 > 0)
+        std::copy_n(ring.data() + scope.startIndex2, scope.blockSize2, dest + scope.blockSize1);
+
+    return scope.blockSize1 + scope.blockSize2;
+}
+
+int GainReductionTap::getNumReady() const
+{
+    return fifo.getNumReady();
+}
+
+void GainReductionTap::discard()
+{
+    fifo.finishedRead(fifo.getNumReady());
+}
@@ -58,6 +58,14 @@ void LevelDetector::setRelease(const double& release)
     }
 }
 
+void LevelDetector::setTimeConstants(double attack, double newAlphaAttack, double release, double newAlphaRelease)
+{
+    attackTimeInSeconds = attack;
+    alphaAttack = newAlphaAttack;
+    releaseTimeInSeconds = release;
+    alphaRelease = newAlphaRelease;
+}
+
 
 double LevelDetector::getAttack()
 {
@@ -79,6 +87,16 @@ double LevelDetector::getAlphaRelease()
     return alphaRelease;
 }
 
+double LevelDetector::getState() const
+{
+    return state01;
+}
+
+void LevelDetector::setState(double newState)
+{
+    state01 = newState;
+}
+
 float LevelDetector::processPeakBranched(const float& in)
 {
     // Smooth branched peak detector
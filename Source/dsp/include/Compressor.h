@@ -35,11 +35,42 @@
 #pragma once
 #include "LevelDetector.h"
 #include "GainComputer.h"
+#include "CompressorKernel.h"
+#include "ParameterSnapshot.h"
+#include "GainReductionTap.h"
+#include "../../util/include/BlockProfiler.h"
+#include <atomic>
 #include "../JuceLibraryCode/JuceHeader.h"
 
 class Compressor
 {
 public:
+    /*
+    * Selects how a block is processed.
+    *
+    * Fused:     stereo link, level detection, gain computation and gain application
+    *            are done sample by sample in a single pass over the block.
+    * Reference: the original multi-pass implementation, kept for comparisons against
+    *            the fused kernel.
+    */
+    enum class ProcessingMode { Fused, Reference };
+
+    /*
+    * Selects how the channels are linked into the single sidechain level.
+    *
+    * Max: largest absolute value across all channels (mono/stereo default, linked inside the kernel).
+    * Sum: sum of the absolute values of all channels.
+    * RMS: root mean square across all channels.
+    */
+    enum class ChannelLink { Max, Sum, RMS };
+
+    // Running statistics of both lanes of processDualLane(), whichever of them is audible
+    struct DualLaneStatistics
+    {
+        LaneStatistics peak;
+        LaneStatistics rms;
+    };
+
     //==============================================================================
     Compressor() = default;
     ~Compressor();
@@ -48,6 +79,11 @@ public:
     void prepare(const juce::dsp::ProcessSpec& ps);
 
     //==============================================================================
+    /*
+    * Threshold, ratio, knee, attack, release and makeup can be set from any thread. They are
+    * published as one snapshot that the audio thread picks up at the start of a block, and
+    * threshold, ratio and makeup are then smoothed sample by sample over parameterSmoothingTime.
+    */
     void setPower(bool);
     void setThreshold(float db);
     void setRatio(float db);
@@ -55,16 +91,85 @@ public:
     void setRelease(float ms);
     void setKnee(float db);
     void setMakeup(float db);
+    void setProcessingMode(ProcessingMode mode);
+    void setMathMode(GainComputer::MathMode mode);
+    void setQuietBlockFastPath(bool enabled);   // optimized (Fused) mode only
+    void setChannelLink(ChannelLink mode);
+
+    // Rebuilds the gain curve table for the latest threshold, ratio and knee if a table math mode
+    // is selected (setMathMode() and prepare() call it). Call it from the message thread after
+    // changing these parameters; the audio thread uses the exact curve until the table is current.
+    void updateCurveTable();
+
+    // Times the sidechain, detector and gain application stages of process() / processDualLane()
+    // (nullptr => no timing)
+    void setProfiler(BlockProfiler* profiler);
+
+    // Delays the audio path by 0 to maxLookaheadMs, the sidechain sees the signal ahead of time.
+    // The delay is reported by getLatencySamples(); the audio thread takes it over at the start
+    // of the next block (offline: in prepareForMetricsExtraction()).
+    void setLookahead(float ms);
+
+    // Evaluates the sidechain every samplesPerControlPoint samples (1 = full rate, or 4, 8,
+    // 16 or 32) and interpolates the gain in between. Only used by ProcessingMode::Fused.
+    void setControlRate(int samplesPerControlPoint);
 
     //==============================================================================
     float getMakeup();
+    ProcessingMode getProcessingMode() const;
+    GainComputer::MathMode getMathMode() const;
+    int getControlRate() const;
+    ChannelLink getChannelLink() const;
+    float getLookahead() const;
+    int getLatencySamples() const;
     double getSampleRate();
     float getMaxGainReduction();
-    juce::AudioBuffer<float> getGainReductionSignal();
+    const juce::AudioBuffer<float>& getGainReductionSignal() const;
+
+    // Gain reduction history written by process() / processDualLane(), one value in dB per
+    // sub-block (its most negative gain reduction); read it from a single GUI thread
+    GainReductionTap& getGainReductionTap();
+    float getAttack();
+    float getRelease();
+
+    // Block counters of applyPeakCompression / applyRMSCompression, i.e. sub-blocks when called
+    // from process() (safe to read from any thread)
+    juce::int64 getNumProcessedBlocks() const;
+    juce::int64 getNumQuietBlocks() const;
+    void resetBlockCounters();
 
     //==============================================================================
+    // Block length of the internal processing; process() accepts any host block length and
+    // splits it into sub-blocks of this size (the last one may be shorter)
+    static constexpr int subBlockSize = 64;
+
+    static constexpr float maxLookaheadMs = 10.0f;
+
+    // Ramp time of threshold, ratio and makeup changes
+    static constexpr double parameterSmoothingTime = 0.02;
+
+    // Compresses the buffer; a bypassed compressor (setPower) only delays it by getLatencySamples()
     void process(juce::AudioBuffer<float>& buffer, bool isRMSmode);
 
+    // Writes the block to the lookahead delay line without processing it. Called for the compressor
+    // that isn't selected, so its delay line is current when it gets selected.
+    void writeLookahead(const juce::AudioBuffer<float>& buffer);
+
+    /*
+    * Shadow processing: compresses the buffer with the compressor selected by isRMSmode and
+    * runs the other topology on the same input as a shadow lane, which only produces gain
+    * reduction (getMaxGainReduction()) and statistics. Both detectors stay warm, so switching
+    * the mode doesn't restart one from a cold state.
+    *
+    * When both compressors use the fused full-rate path with the same math mode and channel
+    * link, without lookahead or a running parameter ramp, the lanes share a single pass over
+    * the block (DualLaneKernel). Otherwise the shadow lane compresses a copy of the block.
+    *
+    * @param statistics  Running statistics, the block is merged into them.
+    */
+    static void processDualLane(Compressor& peak, Compressor& rms, juce::AudioBuffer<float>& buffer,
+        bool isRMSmode, DualLaneStatistics& statistics);
+
     /*
     * Applies Peak-Based Compression to the input buffer.
     *
@@ -99,32 +204,202 @@ public:
     */
     void applyRMSCompression(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, bool trackGR);
 
+    // Copies all compression parameters (not the buffers) from another compressor,
+    // used to create independent compressors for segment-parallel offline processing
+    void copyParametersFrom(const Compressor& other);
+
     void prepareForMetricsExtraction(const juce::dsp::ProcessSpec& audioFilePs);
     void prepareForRealTimeProcessing();
 
 private:
     //==============================================================================
-    void setSidechainSignal(juce::AudioBuffer<float>& buffer, int numSamples);
+    // Parameter set handed over to the audio thread, detector coefficients included
+    struct Parameters
+    {
+        float threshold{ -20.0f };
+        float ratio{ 2.0f };
+        float knee{ 6.0f };
+        float makeup{ 0.0f };
+        float attackMs{ 10.0f }, releaseMs{ 140.0f };
+        double alphaAttack{ 0.0 }, alphaRelease{ 0.0 };
+    };
+
+    void prepareBuffers(const juce::dsp::ProcessSpec& ps);
+
+    // Writer side: applies a change to pendingParameters and publishes them
+    template <typename Change>
+    void updateParameters(Change&& change);
+
+    // Detector coefficient of a time constant; whole milliseconds (the attack/release parameter
+    // grid) are read from detectorCoefficients, anything else is computed
+    double getDetectorCoefficient(float timeInMs) const;
+
+    // Audio thread: picks up a published snapshot, either smoothed or applied immediately
+    void pullParameters(bool smooth);
+    bool isSmoothingParameters() const;
+
+    // Writes the current smoothed values to the gain computer and makeup
+    void applySmoothedParameters();
+
+    /*
+    * Used instead of the fused / reference paths while threshold, ratio or makeup are ramping.
+    * Same per-sample operations as the fused kernel, with the static curve and makeup updated
+    * every sample (exact or fast math, the tables would have to be rebuilt every sample).
+    */
+    template <typename DetectorPolicy>
+    void applyCompressionSmoothed(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels,
+        const float* linkedSidechain, bool trackGR);
+
+    // Peak and RMS compression of a block with an already linked sidechain (nullptr => stereo
+    // max link inside the kernel)
+    void compressPeak(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, const float* linkedSidechain, bool trackGR);
+    void compressRMS(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, const float* linkedSidechain, bool trackGR);
+
+    /*
+    * Lookahead processing: the sidechain is linked from the incoming block and the compressor
+    * runs on a single channel of ones, which turns it into the gain signal (makeup included).
+    * The incoming block is written to the delay line and replaced by the samples delayed by
+    * lookaheadSamples, multiplied by that gain.
+    */
+    template <typename DetectorPolicy>
+    void applyCompressionWithLookahead(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, bool trackGR);
+    void delayAndApplyGain(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, const float* gain);
+    void writeDelayLine(const float* const* channels, int numChannels, int startSample, int numSamples);
+    // Bypassed: the block is only delayed by lookaheadSamples
+    void delayUnprocessed(juce::AudioBuffer<float>& buffer);
+    // Writer side: delay in samples of lookaheadMs at the prepared sample rate
+    void updateTargetLookaheadSamples();
+    // Audio thread: takes over the target delay, clearing the delay line if it changed
+    void latchLookahead();
+
+    // Whether the two compressors can share one DualLaneKernel pass for the next block
+    bool canShareDualLanePass(const Compressor& shadow) const;
+
+    template <typename AudiblePolicy, typename ShadowPolicy>
+    static void runDualLane(Compressor& audible, Compressor& shadow, float* const* channels, int numChannels,
+        int numSamples, const float* linkedSidechain, LaneStatistics& audibleStats, LaneStatistics& shadowStats);
+
+    // Fallback of processDualLane(): compresses the block (or a copy of it, for the shadow lane)
+    // with the regular path and measures its statistics
+    void compressLane(juce::AudioBuffer<float>& block, int numSamples, int numChannels, bool isRMSmode, LaneStatistics& stats);
+
+    void setSidechainSignal(juce::AudioBuffer<float>& buffer, int numSamples, const float* linkedSidechain);
+
+    // Links all channels into linkedSidechainSignal (vectorized per channel); returns nullptr
+    // for the mono/stereo max link, which the kernels do sample by sample
+    const float* linkSidechain(const juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, bool forceSeparatePass);
     void applyCompressionToInputSignal(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels, float makeup);
 
     void saveGainReductionSignal(int numSamples, int numChannels);
-   
+
+    /*
+    * Single-pass counterpart of applyPeakCompression / applyRMSCompression.
+    *
+    * Runs CompressorKernel<DetectorPolicy, KneePolicy>, where the knee policy follows the
+    * gain computer's math mode. Every sample goes through the same operations in the same
+    * order as in the reference path, so with exact math both modes produce identical output.
+    */
+    template <typename DetectorPolicy>
+    void applyCompressionFused(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels,
+        const float* linkedSidechain, bool trackGR);
+
+    // Runs the kernel at full or control rate
+    template <typename DetectorPolicy, typename KneePolicy>
+    float runKernel(float* const* channels, int numChannels, int numSamples, const float* linkedSidechain, DetectorState& detector,
+        const typename KneePolicy::Curve& curve, float* grOut);
+
+    /*
+    * Quiet-block fast path, taken when no sample of the block can produce gain reduction:
+    * - Peak: the block peak is below the start of the knee and the detector has decayed to
+    *         within quietStateThresholdDb of 0 dB.
+    * - RMS:  the larger of the block peak and the current detected level is below the
+    *         start of the knee.
+    * The detector state is still advanced sample by sample with the same recursion as the
+    * full path (without any log/exp), and the block is multiplied by the makeup gain only.
+    * Never taken in ProcessingMode::Reference.
+    *
+    * @return  true if the block was processed, false if the full path has to run.
+    */
+    template <typename DetectorPolicy>
+    bool applyQuietBlock(juce::AudioBuffer<float>& buffer, int numSamples, int numChannels,
+        const float* linkedSidechain, bool trackGR);
+
+    // Parameters as last set by the writer threads, guarded by parameterWriteLock (never taken
+    // on the audio thread); the coefficient table is rebuilt in prepare() under the same lock
+    Parameters pendingParameters;
+    juce::SpinLock parameterWriteLock;
+    std::vector<double> detectorCoefficients;
+    ParameterSnapshot<Parameters> parameterSnapshot;
+
+    // Gain curve table of the table math modes, built by updateCurveTable() and handed over like
+    // the parameters
+    GainCurveTable pendingCurveTable;
+    ParameterSnapshot<GainCurveTable> curveTableSnapshot;
+
+    juce::SmoothedValue<float> smoothedThreshold{ -20.0f };
+    juce::SmoothedValue<float> smoothedRatio{ 2.0f };
+    juce::SmoothedValue<float> smoothedMakeup{ 0.0f };
+
+    // Longest time constant read from detectorCoefficients
+    static constexpr int maxTabulatedTimeMs = 1000;
 
     //Directly initialize process spec to avoid debugging problems
     juce::dsp::ProcessSpec procSpec{ -1, 0, 0 };
 
-    juce::AudioBuffer<float> originalSignal;
+    // Lookahead delay line (power-of-two ring per channel) and the gain applied to its output
+    juce::AudioBuffer<float> delayLine;
+    int delayWritePosition{ 0 };
+    std::vector<float> lookaheadGain;
+    std::atomic<float> lookaheadMs{ 0.0f };
+    std::atomic<int> targetLookaheadSamples{ 0 };   // written by setLookahead() / prepare()
+    int lookaheadSamples{ 0 };                      // latched once per block, audio thread only
+    double sampleRate{ 44100.0 };
     std::vector<float> sidechainSignal;
     float* rawSidechainSignal{ nullptr };
 
     std::vector<float> sidechainRight;
+    std::vector<float> linkedSidechainSignal;
+
+    // Copy of a sub-block compressed by the shadow lane when the lanes can't share a pass
+    juce::AudioBuffer<float> shadowBlock;
 
     juce::AudioBuffer<float> gainReductionSignal;
+    GainReductionTap gainReductionTap;
+
+    // activeProfiler is only set while process() / processDualLane() run
+    BlockProfiler* profiler{ nullptr };
+    BlockProfiler* activeProfiler{ nullptr };
 
     LevelDetector levelDetector;
     
     GainComputer gainComputer;
 
+    ProcessingMode processingMode{ ProcessingMode::Fused };
+    ChannelLink channelLink{ ChannelLink::Max };
+
+    // Distance kept from the start of the knee, covers the fast math and table approximations
+    static constexpr float quietBlockMarginDb = 0.05f;
+    // Largest peak detector state (in dB of gain reduction) that is treated as fully decayed
+    static constexpr double quietStateThresholdDb = 1e-6;
+
+    // Control rate state, gains of the last control point (negative => no previous point)
+    int controlInterval{ 1 };
+    float controlRateGain{ -1.0f };
+    float controlRateGainReduction{ 1.0f };
+
+    // Detector coefficients decimated to the control rate, cached per time constants and rate
+    struct DecimatedCoefficients
+    {
+        double alphaAttack{ -1.0 }, alphaRelease{ -1.0 };
+        double decimatedAttack{ 0.0 }, decimatedRelease{ 0.0 };
+        int interval{ 1 };
+    };
+    DecimatedCoefficients decimated;
+
+    bool quietBlockFastPath{ true };
+    std::atomic<juce::int64> numProcessedBlocks{ 0 };
+    std::atomic<juce::int64> numQuietBlocks{ 0 };
+
     bool RMSModeEnabled{ false };
     bool bypassed{ false };
     
@@ -0,0 +1,288 @@
+/*
+ * This file defines CompressorKernel, a compile-time specialized single-pass compressor.
+ *
+ * CompressorKernel<DetectorPolicy, KneePolicy> builds one fully inlined loop per topology:
+ * - CompressorKernel<PeakDetectorPolicy, ...>: level -> gain computer -> peak detector.
+ * - CompressorKernel<RMSDetectorPolicy, ...>:  level -> RMS detector -> gain computer.
+ * The detector/knee choice is resolved at compile time, so the per-sample loop contains
+ * no indirect calls and no mode branches. The runtime Compressor class only selects the
+ * specialization once per block.
+ *
+ * processControlRate() is the decimated variant of the same loop, evaluating the sidechain
+ * every K samples and interpolating the gain in between.
+ *
+ * DualLaneKernel<AudiblePolicy, ShadowPolicy, KneePolicy> runs the peak and the RMS topology
+ * over the same input in one pass, applying only the audible lane's gain.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "CompressorPolicies.h"
+
+// Running gain reduction and output level statistics of one compressor lane
+struct LaneStatistics
+{
+    float maxGainReduction{ 0.0f };       // dB, most negative value
+    double sumGainReduction{ 0.0 };       // dB, summed over the samples
+    double sumOutputSquares{ 0.0 };       // summed over the samples and channels
+    juce::int64 numSamples{ 0 };
+
+    void merge(const LaneStatistics& other)
+    {
+        maxGainReduction = std::min(maxGainReduction, other.maxGainReduction);
+        sumGainReduction += other.sumGainReduction;
+        sumOutputSquares += other.sumOutputSquares;
+        numSamples += other.numSamples;
+    }
+};
+
+template <typename DetectorPolicy, typename KneePolicy>
+class CompressorKernel
+{
+public:
+    /*
+    * Compresses a block in place.
+    *
+    * @param channels     Channel pointers of the block.
+    * @param numChannels  Number of channels, the gain is applied to all of them.
+    * @param numSamples   Number of samples in the block.
+    * @param sidechain    Linked sidechain level per sample, or nullptr to link the first two
+    *                     channels (stereo max) inside the loop.
+    * @param detector     Detector state and coefficients, updated in place.
+    * @param curve        Static compression curve (parameters or table, depending on the knee policy).
+    * @param makeup       Makeup gain in dB.
+    * @param grOut        Optional destination for the linear gain reduction signal (nullptr => skip).
+    * @return             Maximum gain reduction of the block in dB (most negative value).
+    */
+    static float process(float* const* channels, int numChannels, int numSamples, const float* sidechain,
+        DetectorState& detector, const typename KneePolicy::Curve& curve, float makeup, float* grOut)
+    {
+        if (sidechain != nullptr)
+            return processBlock([sidechain](int i) { return sidechain[i]; },
+                channels, numChannels, numSamples, detector, curve, makeup, grOut);
+
+        return processBlock(StereoLink{ channels, numChannels > 1 ? 1 : 0 },
+            channels, numChannels, numSamples, detector, curve, makeup, grOut);
+    }
+
+    /*
+    * Control-rate variant of process().
+    *
+    * The sidechain is evaluated once per group of controlInterval samples, from the largest
+    * linked level of the group. The detector coefficients have to be decimated accordingly
+    * (alpha^controlInterval). The linear gain is interpolated from the previous control point
+    * to the current one over the samples of the group. A shorter last group uses coefficients
+    * decimated by its own length.
+    *
+    * @param controlInterval        Number of samples per control point.
+    * @param previousGain           Linear gain (incl. makeup) of the last control point, updated
+    *                               in place; a negative value starts without interpolation.
+    * @param previousGainReduction  Linear gain reduction of the last control point, updated in place.
+    * Other parameters and the return value are the same as in process().
+    */
+    static float processControlRate(float* const* channels, int numChannels, int numSamples, const float* sidechain,
+        int controlInterval, DetectorState& detector, const typename KneePolicy::Curve& curve, float makeup,
+        float& previousGain, float& previousGainReduction, float* grOut)
+    {
+        if (sidechain != nullptr)
+            return processBlockControlRate([sidechain](int i) { return sidechain[i]; },
+                channels, numChannels, numSamples, controlInterval, detector, curve, makeup,
+                previousGain, previousGainReduction, grOut);
+
+        return processBlockControlRate(StereoLink{ channels, numChannels > 1 ? 1 : 0 },
+            channels, numChannels, numSamples, controlInterval, detector, curve, makeup,
+            previousGain, previousGainReduction, grOut);
+    }
+
+    // Runs one sidechain sample through the detector and gain computer in the order of the topology
+    static float computeGainReduction(DetectorState& detector, const typename KneePolicy::Curve& curve, float level)
+    {
+        if constexpr (DetectorPolicy::smoothsGainReduction)
+        {
+            const float staticGainReduction = KneePolicy::levelToGainReduction(level, curve);
+            return DetectorPolicy::process(detector, staticGainReduction);
+        }
+        else
+        {
+            const float detectedLevel = DetectorPolicy::process(detector, level);
+            return KneePolicy::levelToGainReduction(detectedLevel, curve);
+        }
+    }
+
+private:
+    // Stereo link - the larger amplitude across the two channels drives the sidechain
+    // (right == 0 for mono)
+    struct StereoLink
+    {
+        float* const* channels;
+        int right;
+
+        float operator()(int i) const
+        {
+            return std::max(std::abs(channels[0][i]), std::abs(channels[right][i]));
+        }
+    };
+
+    template <typename LevelSource>
+    static float processBlock(LevelSource levelAt, float* const* channels, int numChannels, int numSamples,
+        DetectorState& detector, const typename KneePolicy::Curve& curve, float makeup, float* grOut)
+    {
+        float minGainReduction = 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float gainReductionInDb = computeGainReduction(detector, curve, levelAt(i));
+
+            minGainReduction = std::min(minGainReduction, gainReductionInDb);
+
+            if (grOut != nullptr)
+                grOut[i] = KneePolicy::toGain(gainReductionInDb);
+
+            // Add makeup gain, convert to linear domain and apply to every channel
+            const float gain = KneePolicy::toGain(gainReductionInDb + makeup);
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch][i] *= gain;
+        }
+
+        return minGainReduction;
+    }
+
+    template <typename LevelSource>
+    static float processBlockControlRate(LevelSource levelAt, float* const* channels, int numChannels, int numSamples,
+        int controlInterval, DetectorState& detector, const typename KneePolicy::Curve& curve, float makeup,
+        float& previousGain, float& previousGainReduction, float* grOut)
+    {
+        float minGainReduction = 0.0f;
+
+        for (int start = 0; start < numSamples; start += controlInterval)
+        {
+            const int n = std::min(controlInterval, numSamples - start);
+
+            // Largest linked level of the group
+            float level = 0.0f;
+            for (int i = start; i < start + n; ++i)
+                level = std::max(level, levelAt(i));
+
+            float gainReductionInDb;
+            if (n == controlInterval)
+            {
+                gainReductionInDb = computeGainReduction(detector, curve, level);
+            }
+            else
+            {
+                const double exponent = static_cast<double>(n) / controlInterval;
+                DetectorState shortGroup{ detector.state,
+                    std::pow(detector.alphaAttack, exponent), std::pow(detector.alphaRelease, exponent) };
+                gainReductionInDb = computeGainReduction(shortGroup, curve, level);
+                detector.state = shortGroup.state;
+            }
+
+            minGainReduction = std::min(minGainReduction, gainReductionInDb);
+
+            const float gain = KneePolicy::toGain(gainReductionInDb + makeup);
+            const float gainReduction = KneePolicy::toGain(gainReductionInDb);
+            if (previousGain < 0.0f)
+            {
+                previousGain = gain;
+                previousGainReduction = gainReduction;
+            }
+
+            // Linear interpolation, the last sample of the group gets the control point value
+            const float gainStep = (gain - previousGain) / n;
+            const float gainReductionStep = (gainReduction - previousGainReduction) / n;
+
+            for (int i = 0; i < n; ++i)
+            {
+                const float g = (i == n - 1) ? gain : previousGain + gainStep * (i + 1);
+                for (int ch = 0; ch < numChannels; ++ch)
+                    channels[ch][start + i] *= g;
+
+                if (grOut != nullptr)
+                    grOut[start + i] = (i == n - 1) ? gainReduction : previousGainReduction + gainReductionStep * (i + 1);
+            }
+
+            previousGain = gain;
+            previousGainReduction = gainReduction;
+        }
+
+        return minGainReduction;
+    }
+};
+
+template <typename AudiblePolicy, typename ShadowPolicy, typename KneePolicy>
+class DualLaneKernel
+{
+public:
+    /*
+    * Compresses a block in place with the audible lane, while the shadow lane runs its own
+    * topology on the same linked levels without touching the audio.
+    *
+    * Both lanes share the sidechain read and the pass over the channels. Their detector and
+    * gain computer chains are independent, so they execute interleaved in the same loop. The
+    * shadow lane's output level is derived from the input energy of the sample and its gain.
+    *
+    * @param audible, shadow            Detector state and coefficients of each lane, updated in place.
+    * @param audibleCurve, shadowCurve  Static compression curve of each lane.
+    * @param audibleMakeup, shadowMakeup  Makeup gain of each lane in dB.
+    * @param audibleStats, shadowStats  Statistics of the block for each lane (overwritten).
+    * Other parameters are the same as in CompressorKernel::process().
+    */
+    static void process(float* const* channels, int numChannels, int numSamples, const float* sidechain,
+        DetectorState& audible, const typename KneePolicy::Curve& audibleCurve, float audibleMakeup,
+        DetectorState& shadow, const typename KneePolicy::Curve& shadowCurve, float shadowMakeup,
+        LaneStatistics& audibleStats, LaneStatistics& shadowStats)
+    {
+        using AudibleLane = CompressorKernel<AudiblePolicy, KneePolicy>;
+        using ShadowLane = CompressorKernel<ShadowPolicy, KneePolicy>;
+
+        audibleStats = {};
+        shadowStats = {};
+        audibleStats.numSamples = shadowStats.numSamples = numSamples;
+
+        const int right = numChannels > 1 ? 1 : 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float level = sidechain != nullptr
+                ? sidechain[i]
+                : std::max(std::abs(channels[0][i]), std::abs(channels[right][i]));
+
+            const float audibleGainReduction = AudibleLane::computeGainReduction(audible, audibleCurve, level);
+            const float shadowGainReduction = ShadowLane::computeGainReduction(shadow, shadowCurve, level);
+
+            const float audibleGain = KneePolicy::toGain(audibleGainReduction + audibleMakeup);
+            const float shadowGain = KneePolicy::toGain(shadowGainReduction + shadowMakeup);
+
+            float inputSquares = 0.0f;
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float x = channels[ch][i];
+                inputSquares += x * x;
+                channels[ch][i] = x * audibleGain;
+            }
+
+            audibleStats.maxGainReduction = std::min(audibleStats.maxGainReduction, audibleGainReduction);
+            audibleStats.sumGainReduction += audibleGainReduction;
+            audibleStats.sumOutputSquares += inputSquares * audibleGain * audibleGain;
+
+            shadowStats.maxGainReduction = std::min(shadowStats.maxGainReduction, shadowGainReduction);
+            shadowStats.sumGainReduction += shadowGainReduction;
+            shadowStats.sumOutputSquares += inputSquares * shadowGain * shadowGain;
+        }
+    }
+};
@@ -0,0 +1,185 @@
+/*
+ * This file defines the detector and knee policies used by CompressorKernel.
+ *
+ * A detector policy describes where the smoothing filter sits in the sidechain and how a
+ * single sample is smoothed:
+ * - smoothsGainReduction == true:  level -> gain computer -> detector (log domain, peak).
+ * - smoothsGainReduction == false: level -> detector -> gain computer (linear domain, RMS).
+ * New detector types are added by writing a new policy with the same interface; the kernel
+ * loop itself does not change.
+ *
+ * A knee policy provides the lin -> gain reduction mapping (lin -> dB conversion and static
+ * curve) and the dB -> lin conversion used by the kernel, together with the type of the curve
+ * description it reads:
+ * - ExactKnee:        juce::Decibels conversions and the branched CTAGDRC curve (reference).
+ * - FastKnee:         FastMath approximations and the branchless curve.
+ * - DecibelTableKnee: juce::Decibels conversions and the dB-indexed GainCurveTable.
+ * - LevelTableKnee:   the level-indexed GainCurveTable (no log), juce::Decibels dB -> lin.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "FastMath.h"
+#include "GainCurveTable.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// Coefficients and state of the one-pole smoothing filter, kept in registers by the kernel
+struct DetectorState
+{
+    double state{ 0.0 };
+    double alphaAttack{ 0.0 };
+    double alphaRelease{ 0.0 };
+};
+
+// DETECTOR POLICIES
+//==============================================================================
+
+// Smooth branched peak detector, placed after the gain computer (input is gain reduction in dB)
+struct PeakDetectorPolicy
+{
+    static constexpr bool smoothsGainReduction = true;
+
+    static float process(DetectorState& d, float in)
+    {
+        update(d, in);
+        return static_cast<float>(d.state);
+    }
+
+    // Advances the filter state only
+    static void update(DetectorState& d, float in)
+    {
+        if (in < d.state) // since peak detector is placed after gain computer, the input values are negative
+            d.state = d.alphaAttack * d.state + (1 - d.alphaAttack) * in;
+        else
+            d.state = d.alphaRelease * d.state + (1 - d.alphaRelease) * in;
+    }
+};
+
+// Smooth branched RMS detector, placed before the gain computer (input is the linear level)
+struct RMSDetectorPolicy
+{
+    static constexpr bool smoothsGainReduction = false;
+
+    static float process(DetectorState& d, float in)
+    {
+        update(d, in);
+
+        // Adjust RMS values to make up for time constants scaling
+        return std::sqrtf(static_cast<float>(d.state)) * (1 / std::sqrtf(2.0f));
+    }
+
+    // Advances the filter state only (mean square of the level)
+    static void update(DetectorState& d, float in)
+    {
+        float inSquared = in * in;
+
+        if (inSquared > d.state)
+            d.state = d.alphaAttack * d.state + (1 - d.alphaAttack) * inSquared;
+        else
+            d.state = d.alphaRelease * d.state + (1 - d.alphaRelease) * inSquared;
+    }
+};
+
+// KNEE POLICIES
+//==============================================================================
+struct ExactKnee
+{
+    using Curve = FastMath::KneeCurve;
+
+    static float levelToGainReduction(float level, const Curve& c)
+    {
+        return gainReduction(toDecibels(level), c);
+    }
+
+    static float toDecibels(float level)
+    {
+        return juce::Decibels::gainToDecibels(std::max(level, FastMath::minLevel));
+    }
+
+    static float gainReduction(float levelInDecibels, const FastMath::KneeCurve& c)
+    {
+        const float overshoot = levelInDecibels - c.threshold;
+
+        if (overshoot <= -c.kneeHalf)
+            return 0.0f;
+        if (overshoot > -c.kneeHalf && overshoot <= c.kneeHalf)
+            return 0.5f * c.slope * ((overshoot + c.kneeHalf) * (overshoot + c.kneeHalf)) / c.knee;
+
+        return c.slope * overshoot;
+    }
+
+    static float toGain(float db)
+    {
+        return juce::Decibels::decibelsToGain(db);
+    }
+};
+
+struct FastKnee
+{
+    using Curve = FastMath::KneeCurve;
+
+    static float levelToGainReduction(float level, const Curve& c)
+    {
+        return gainReduction(toDecibels(level), c);
+    }
+
+    static float toDecibels(float level)
+    {
+        return FastMath::gainToDecibels(std::max(level, FastMath::minLevel));
+    }
+
+    static float gainReduction(float levelInDecibels, const FastMath::KneeCurve& c)
+    {
+        return FastMath::applyKneeCurve(levelInDecibels, c);
+    }
+
+    static float toGain(float db)
+    {
+        return FastMath::decibelsToGain(db);
+    }
+};
+
+struct DecibelTableKnee
+{
+    using Curve = GainCurveTable;
+
+    static float levelToGainReduction(float level, const Curve& table)
+    {
+        return table.lookupDecibels(ExactKnee::toDecibels(level));
+    }
+
+    static float toGain(float db)
+    {
+        return ExactKnee::toGain(db);
+    }
+};
+
+struct LevelTableKnee
+{
+    using Curve = GainCurveTable;
+
+    static float levelToGainReduction(float level, const Curve& table)
+    {
+        return table.lookupLevel(std::max(level, FastMath::minLevel));
+    }
+
+    static float toGain(float db)
+    {
+        return ExactKnee::toGain(db);
+    }
+};
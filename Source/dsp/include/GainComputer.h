@@ -33,10 +33,17 @@
  */
 
 #pragma once
+#include "FastMath.h"
+#include "GainCurveTable.h"
 
 class GainComputer
 {
 public:
+    // Exact: juce::Decibels conversions and the branched static curve (reference)
+    // Fast:  polynomial log2 approximation with vectorized, branchless static curve (see FastMath.h)
+    // DecibelTable: juce::Decibels conversions, static curve read from a dB-indexed table
+    // LevelTable:   static curve read from a table indexed by the bits of the linear level (no log)
+    enum class MathMode { Exact, Fast, DecibelTable, LevelTable };
 
     GainComputer();
 
@@ -53,11 +60,34 @@ public:
     // returns attenuation
     float applyCompression(float&);
 
+    // Branchless version of applyCompression, identical up to float rounding
+    float applyCompressionBranchless(float levelInDecibels) const;
+
     void applyCompressionToBuffer(float*, int);
 
+    // Selects exact or fast math for applyCompressionToBuffer
+    void setMathMode(MathMode mode);
+    MathMode getMathMode() const;
+
+    // Math mode actually used: the table modes fall back to Exact while the table of
+    // setCurveTable() isn't built for the current curve (it is never built here)
+    MathMode getActiveMathMode() const;
+
+    // Gets the static curve in the form used by the FastMath kernels
+    FastMath::KneeCurve getKneeCurve() const;
+
+    // Table of the static curve for the table math modes, built by the owner off the audio thread
+    void setCurveTable(const GainCurveTable* table);
+
+    // Gets the table of setCurveTable(), only valid while getActiveMathMode() is a table mode
+    const GainCurveTable& getCurveTable() const;
+
     float threshold{ -20.0f };
     float ratio{ 2.0f };
 private:
     float knee{ 6.0f }, kneeHalf{ 3.0f };
     float slope{ -0.5f };
+    MathMode mathMode{ MathMode::Exact };
+
+    const GainCurveTable* curveTable{ nullptr };
 };
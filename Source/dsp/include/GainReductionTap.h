@@ -0,0 +1,59 @@
+/*
+ * This file defines GainReductionTap, a real-time safe history of the gain reduction.
+ *
+ * The compressor pushes one value per sub-block from the audio thread: the most negative
+ * gain reduction in dB of the sub-block (min-hold over Compressor::subBlockSize samples).
+ * The GUI pops the values from the message thread.
+ *
+ * This file handles:
+ * - A preallocated single-producer/single-consumer ring (juce::AbstractFifo), no locks and
+ *   no allocations on either side.
+ * - Values that don't fit because the reader fell behind are dropped, the audio thread
+ *   never waits.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <vector>
+
+class GainReductionTap
+{
+public:
+    GainReductionTap() = default;
+
+    // Allocates the ring for at least capacity values (not on the audio thread). The ring is
+    // kept if it already has the requested size, so the reader may keep running.
+    void prepare(int capacity);
+
+    // Audio thread: appends one gain reduction value in dB
+    void push(float gainReductionInDb);
+
+    // Reader thread: copies up to maxValues of the oldest unread values to dest, returns the count
+    int pop(float* dest, int maxValues);
+
+    // Number of values ready to be popped
+    int getNumReady() const;
+
+    // Reader thread: drops all unread values
+    void discard();
+
+private:
+    juce::AbstractFifo fifo{ 1 };
+    std::vector<float> ring;
+};
@@ -43,6 +43,9 @@ public:
     // Sets release time constant
     void setRelease(const double&);
 
+    // Sets both time constants with coefficients computed by the caller (no exp() on the calling thread)
+    void setTimeConstants(double attack, double alphaAttack, double release, double alphaRelease);
+
     // Gets current attack time constant
     double getAttack();
 
@@ -55,6 +58,10 @@ public:
     // gets calculated release coefficient
     double getAlphaRelease();
 
+    // Gets/sets the smoothing filter state, used by CompressorKernel to keep the state in registers
+    double getState() const;
+    void setState(double newState);
+
     // Processes a sample with smooth branched peak detector
     float processPeakBranched(const float&);
 
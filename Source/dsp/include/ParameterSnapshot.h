@@ -0,0 +1,69 @@
+/*
+ * This file defines ParameterSnapshot, a lock-free hand-over of a parameter set from the
+ * threads that change parameters to the audio thread.
+ *
+ * The writer fills a complete copy of the parameters and publishes it, the audio thread picks
+ * up the most recent published copy at the start of a block. Neither side ever waits for the
+ * other and the audio thread never sees a partially written set:
+ * - Three slots are used: the one the writer fills, the one the reader uses, and a spare one
+ *   exchanged atomically between them (plus a flag telling the reader that it holds new data).
+ * - Only one thread may publish at a time (the caller serializes writers), and only one
+ *   thread may pull.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+
+template <typename Parameters>
+class ParameterSnapshot
+{
+public:
+    // Writer side: copies the parameters into the free slot and hands it over to the reader
+    void publish(const Parameters& parameters)
+    {
+        slots[writeIndex] = parameters;
+        writeIndex = spare.exchange(writeIndex | newDataFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Reader side: takes over the last published parameters, returns false if nothing new was published
+    bool pull()
+    {
+        if ((spare.load(std::memory_order_relaxed) & newDataFlag) == 0)
+            return false;
+
+        readIndex = spare.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    // Reader side: parameters of the last pull()
+    const Parameters& current() const
+    {
+        return slots[readIndex];
+    }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int newDataFlag = 4;
+
+    std::array<Parameters, 3> slots{};
+    int writeIndex{ 0 };
+    std::atomic<int> spare{ 1 };
+    int readIndex{ 2 };
+};
@@ -0,0 +1,72 @@
+/*
+ * This file implements GainReductionHistory, a scrolling gain reduction display.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/GainReductionHistory.h"
+
+GainReductionHistory::GainReductionHistory()
+{
+    history.assign(historyLength, 0.0f);
+    backgroundDarkGrey = Colour(juce::Colours::darkgrey);
+}
+
+void GainReductionHistory::update(GainReductionTap& tap)
+{
+    int numRead = 0;
+    while (tap.getNumReady() > 0)
+    {
+        const int n = tap.pop(readBuffer.data(), static_cast<int>(readBuffer.size()));
+        for (int i = 0; i < n; ++i)
+        {
+            history[static_cast<size_t>(writeIndex)] = readBuffer[static_cast<size_t>(i)];
+            writeIndex = (writeIndex + 1) % historyLength;
+        }
+        numRead += n;
+    }
+
+    if (numRead > 0)
+        repaint();
+}
+
+void GainReductionHistory::paint(Graphics& g)
+{
+    const auto bounds = getLocalBounds().toFloat();
+    g.setColour(backgroundDarkGrey);
+    g.fillRoundedRectangle(bounds, 3);
+
+    // 0 dB at the top edge, rangeInDecibels of gain reduction at the bottom edge
+    auto toY = [&bounds](float gainReductionInDb)
+        {
+            const float proportion = jlimit(0.0f, 1.0f, -gainReductionInDb / rangeInDecibels);
+            return bounds.getY() + proportion * bounds.getHeight();
+        };
+
+    Path envelope;
+    envelope.startNewSubPath(bounds.getX(), bounds.getY());
+    for (int i = 0; i < historyLength; ++i)
+    {
+        const float x = bounds.getX() + bounds.getWidth() * static_cast<float>(i) / static_cast<float>(historyLength - 1);
+        envelope.lineTo(x, toY(history[static_cast<size_t>((writeIndex + i) % historyLength)]));
+    }
+    envelope.lineTo(bounds.getRight(), bounds.getY());
+    envelope.closeSubPath();
+
+    g.setColour(Colours::lightgrey.withAlpha(0.6f));
+    g.fillPath(envelope);
+}
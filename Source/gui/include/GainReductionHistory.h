@@ -0,0 +1,49 @@
+/*
+ * This file defines GainReductionHistory, a component that displays a scrolling history of
+ * the gain reduction read from a GainReductionTap.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../../dsp/include/GainReductionTap.h"
+#include <array>
+#include <vector>
+
+using namespace juce;
+
+class GainReductionHistory : public Component
+{
+public:
+    GainReductionHistory();
+    void paint(Graphics& g) override;
+
+    // Appends all values the tap has ready, called from the editor's timer
+    void update(GainReductionTap& tap);
+
+private:
+    // Number of values shown across the width, newest on the right
+    static constexpr int historyLength = 1024;
+    // Gain reduction at the bottom edge
+    static constexpr float rangeInDecibels = 24.0f;
+
+    std::vector<float> history;
+    int writeIndex{ 0 };
+    std::array<float, 256> readBuffer{};
+    Colour backgroundDarkGrey;
+};
@@ -1,5 +1,6 @@
 #include "include/AudioFileLoader.h"
 
+#if JUCE_MODULE_AVAILABLE_juce_gui_basics
 juce::File AudioFileLoader::chooseAudioFile()
 {
     juce::FileChooser chooser(
@@ -17,28 +18,28 @@ juce::File AudioFileLoader::chooseAudioFile()
 
     return f;
 }
+#endif
 
 std::optional<AudioFileLoader::LoadedAudio>
-AudioFileLoader::loadAudioFile(const juce::File& file, juce::String* error) const
+AudioFileLoader::loadAudioFile(const juce::File& file, juce::String* error, double maxDurationSeconds) const
 {
-    if (!file.existsAsFile())
-    {
-        if (error) *error = "File does not exist.";
+    auto reader = createReader(file, error);
+    if (!reader)
         return std::nullopt;
-    }
 
-    auto reader = std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(file));
-    if (!reader)
+    // The whole file goes into one AudioBuffer, which is indexed with int
+    if (reader->lengthInSamples > std::numeric_limits<int>::max())
     {
-        if (error) *error = "Unable to create reader.";
+        if (error) *error = "File is too long to be loaded at once, use the streaming mode.";
         return std::nullopt;
     }
 
-    // Enforce mono or stereo only
-    if (reader->numChannels < 1 || reader->numChannels > 2)
+    const double duration = static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
+    if (maxDurationSeconds > 0.0 && duration > maxDurationSeconds)
     {
         if (error)
-            *error = "Only mono and stereo audio files are supported.";
+            *error = "File is longer than " + juce::String(maxDurationSeconds / 60.0, 1)
+                   + " minutes, use the streaming mode.";
         return std::nullopt;
     }
 
@@ -53,3 +54,69 @@ AudioFileLoader::loadAudioFile(const juce::File& file, juce::String* error) cons
 
     return out;
 }
+
+std::unique_ptr<juce::AudioFormatReader>
+AudioFileLoader::createReader(const juce::File& file, juce::String* error) const
+{
+    if (!file.existsAsFile())
+    {
+        if (error) *error = "File does not exist.";
+        return nullptr;
+    }
+
+    auto reader = useMemoryMapping ? createMemoryMappedReader(file) : nullptr;
+    const bool isMemoryMapped = reader != nullptr;
+    if (!reader)
+        reader.reset(formatManager.createReaderFor(file));
+
+    if (!reader)
+    {
+        if (error) *error = "Unable to create reader.";
+        return nullptr;
+    }
+
+    // Formats that have to be decoded are read from the cache, decoded into it on the first use
+    if (decodedAudioCache != nullptr && !isMemoryMapped)
+    {
+        const auto key = DecodedAudioCache::makeKey(file, reader->sampleRate);
+
+        auto cached = decodedAudioCache->createReader(key);
+        if (!cached)
+            cached = decodedAudioCache->store(key, *reader);
+
+        // A failing cache (e.g. disk full) falls back to decoding the file directly
+        if (cached)
+            reader = std::move(cached);
+    }
+
+    // Enforce mono or stereo only
+    if (reader->numChannels < 1 || reader->numChannels > 2)
+    {
+        if (error)
+            *error = "Only mono and stereo audio files are supported.";
+        return nullptr;
+    }
+
+    if (reader->sampleRate <= 0.0)
+    {
+        if (error) *error = "Invalid sample rate.";
+        return nullptr;
+    }
+
+    return reader;
+}
+
+std::unique_ptr<juce::AudioFormatReader>
+AudioFileLoader::createMemoryMappedReader(const juce::File& file) const
+{
+    // Only formats with a fixed sample layout (WAV, AIFF) return a memory mapped reader
+    auto* format = formatManager.findFormatForFileExtension(file.getFileExtension());
+    if (format == nullptr)
+        return nullptr;
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader(format->createMemoryMappedReader(file));
+    if (!reader || !reader->mapEntireFile())
+        return nullptr;
+
+    return reader;
+}
@@ -52,6 +52,28 @@ bool DataExport::exportMetricsOnly(const juce::File& inputFile,
     return saveText(metricsFile, metricsText, error);
 }
 
+std::unique_ptr<juce::AudioFormatWriter> DataExport::createWavWriter(const juce::File& inputFile,
+    const juce::String& suffix,
+    double sampleRate,
+    int numChannels,
+    juce::String* error)
+{
+    if (!cfg.exportWavs || !ensureOutputFolder(error))
+        return nullptr;
+
+    return createWriter(makeUniqueFile(inputFile, suffix, ".wav"), sampleRate, numChannels, cfg.bitDepth, error);
+}
+
+bool DataExport::exportProfile(const juce::String& profileText,
+    juce::String* error)
+{
+    if (!ensureOutputFolder(error))
+        return false;
+
+    auto profileFile = makeUniqueFile("ProcessBlock", "Profile", ".txt");
+    return saveText(profileFile, profileText, error);
+}
+
 bool DataExport::ensureOutputFolder(juce::String* error)
 {
     if (outputFolder != juce::File() && outputFolder.exists())
@@ -75,8 +97,14 @@ juce::File DataExport::makeUniqueFile(const juce::File& inputFile,
     const juce::String& suffix,
     const juce::String& extension) const
 {
-    auto base = outputFolder.getChildFile(inputFile.getFileNameWithoutExtension()
-        + "_" + suffix + extension);
+    return makeUniqueFile(inputFile.getFileNameWithoutExtension(), suffix, extension);
+}
+
+juce::File DataExport::makeUniqueFile(const juce::String& baseName,
+    const juce::String& suffix,
+    const juce::String& extension) const
+{
+    auto base = outputFolder.getChildFile(baseName + "_" + suffix + extension);
 
     auto unique = base;
     int counter = 2;
@@ -112,18 +140,39 @@ bool DataExport::saveWav(const juce::File& file,
     double sampleRate,
     int bitDepth,
     juce::String* error) const
+{
+    auto writer = createWriter(file, sampleRate, buffer.getNumChannels(), bitDepth, error);
+    if (!writer)
+        return false;
+
+    writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+    return true;
+}
+
+std::unique_ptr<juce::AudioFormatWriter> DataExport::createWriter(const juce::File& file,
+    double sampleRate,
+    int numChannels,
+    int bitDepth,
+    juce::String* error) const
 {
     if (sampleRate <= 0.0)
     {
         if (error) *error = "Invalid sample rate for WAV export.";
-        return false;
+        return nullptr;
+    }
+
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+    if (stream->failedToOpen())
+    {
+        if (error) *error = "Failed to open WAV stream for: " + file.getFullPathName();
+        return nullptr;
     }
 
     juce::WavAudioFormat format;
     std::unique_ptr<juce::AudioFormatWriter> writer(
-        format.createWriterFor(new juce::FileOutputStream(file),
+        format.createWriterFor(stream.get(),
             sampleRate,
-            (unsigned int)buffer.getNumChannels(),
+            (unsigned int)numChannels,
             bitDepth,
             {},
             0));
@@ -131,9 +180,10 @@ bool DataExport::saveWav(const juce::File& file,
     if (!writer)
     {
         if (error) *error = "Failed to create WAV writer for: " + file.getFullPathName();
-        return false;
+        return nullptr;
     }
 
-    writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
-    return true;
+    // The writer owns the stream from here on
+    stream.release();
+    return writer;
 }
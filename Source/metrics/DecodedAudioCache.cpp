@@ -0,0 +1,295 @@
+/*
+ * This file implements DecodedAudioCache, see DecodedAudioCache.h.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/DecodedAudioCache.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    // 64-bit multiply / xor-shift hash over 8 byte words, fast enough to be limited by the disk
+    class ContentHash
+    {
+    public:
+        void add(const void* data, size_t numBytes)
+        {
+            auto* bytes = static_cast<const juce::uint8*>(data);
+            length += numBytes;
+
+            // Complete a word left over from the previous block
+            while (numBytes > 0 && pendingBytes > 0)
+            {
+                addByte(*bytes++);
+                --numBytes;
+            }
+
+            for (; numBytes >= 8; numBytes -= 8, bytes += 8)
+            {
+                juce::uint64 word;
+                std::memcpy(&word, bytes, 8);
+                mix(word);
+            }
+
+            while (numBytes-- > 0)
+                addByte(*bytes++);
+        }
+
+        juce::uint64 finish()
+        {
+            if (pendingBytes > 0)
+                mix(pending);
+
+            juce::uint64 h = state ^ length;
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+    private:
+        void addByte(juce::uint8 byte)
+        {
+            pending |= static_cast<juce::uint64>(byte) << (8 * pendingBytes);
+            if (++pendingBytes == 8)
+            {
+                mix(pending);
+                pending = 0;
+                pendingBytes = 0;
+            }
+        }
+
+        void mix(juce::uint64 word)
+        {
+            state = (state ^ (word * 0x9e3779b97f4a7c15ULL)) * 0xbf58476d1ce4e5b9ULL;
+            state ^= state >> 29;
+        }
+
+        juce::uint64 state{ 0x243f6a8885a308d3ULL };
+        juce::uint64 length{ 0 };
+        juce::uint64 pending{ 0 };
+        int pendingBytes{ 0 };
+    };
+
+    const char entryMagic[4] = { 'P', 'R', 'D', 'C' };
+    const char* const entryExtension = ".pcm";
+}
+
+//==============================================================================
+// AudioFormatReader over a memory mapped cache entry
+class DecodedAudioCache::CachedReader : public juce::AudioFormatReader
+{
+public:
+    CachedReader(std::unique_ptr<juce::MemoryMappedFile> mappedFile, const Header& header)
+        : juce::AudioFormatReader(nullptr, "Decoded audio cache"),
+          map(std::move(mappedFile))
+    {
+        sampleRate = header.sampleRate;
+        bitsPerSample = 32;
+        lengthInSamples = header.numSamples;
+        numChannels = header.numChannels;
+        usesFloatingPointData = true;
+
+        samples = reinterpret_cast<const float*>(static_cast<const char*>(map->getData()) + sizeof(Header));
+    }
+
+    bool readSamples(int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+        juce::int64 startSampleInFile, int numSamples) override
+    {
+        clearSamplesBeyondAvailableLength(destChannels, numDestChannels, startOffsetInDestBuffer,
+            startSampleInFile, numSamples, lengthInSamples);
+
+        if (numSamples <= 0)
+            return true;
+
+        for (int ch = 0; ch < numDestChannels; ++ch)
+        {
+            if (destChannels[ch] == nullptr)
+                continue;
+
+            // Like the other readers, missing channels repeat the last one
+            const int sourceChannel = juce::jmin(ch, static_cast<int>(numChannels) - 1);
+            const float* source = samples + sourceChannel * lengthInSamples + startSampleInFile;
+            std::memcpy(destChannels[ch] + startOffsetInDestBuffer, source, sizeof(float) * static_cast<size_t>(numSamples));
+        }
+
+        return true;
+    }
+
+private:
+    std::unique_ptr<juce::MemoryMappedFile> map;
+    const float* samples = nullptr;
+};
+
+//==============================================================================
+DecodedAudioCache::DecodedAudioCache(Config c) : cfg(std::move(c))
+{
+    if (cfg.directory == juce::File())
+        cfg.directory = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("PeakRMSCompressorWorkbench_decoded");
+}
+
+juce::String DecodedAudioCache::makeKey(const juce::File& file, double sampleRate)
+{
+    ContentHash hash;
+
+    juce::FileInputStream stream(file);
+    if (stream.openedOk())
+    {
+        juce::HeapBlock<char> block(1 << 20);
+        for (;;)
+        {
+            const int numRead = stream.read(block.getData(), 1 << 20);
+            if (numRead <= 0)
+                break;
+            hash.add(block.getData(), static_cast<size_t>(numRead));
+        }
+    }
+
+    return juce::String::toHexString(static_cast<juce::int64>(hash.finish())).paddedLeft('0', 16)
+        + "_" + juce::String(file.getSize())
+        + "_" + juce::String(juce::roundToInt(sampleRate));
+}
+
+std::unique_ptr<juce::AudioFormatReader> DecodedAudioCache::createReader(const juce::String& key) const
+{
+    const auto entry = getEntryFile(key);
+    if (!entry.existsAsFile())
+        return nullptr;
+
+    auto map = std::make_unique<juce::MemoryMappedFile>(entry, juce::MemoryMappedFile::readOnly);
+    if (map->getData() == nullptr || map->getSize() < sizeof(Header))
+        return nullptr;
+
+    Header header;
+    std::memcpy(&header, map->getData(), sizeof(Header));
+
+    const auto expectedSize = sizeof(Header) + sizeof(float) * static_cast<size_t>(header.numChannels) * static_cast<size_t>(header.numSamples);
+    if (std::memcmp(header.magic, entryMagic, 4) != 0 || header.version != currentVersion
+        || header.numChannels == 0 || header.numSamples < 0 || map->getSize() != expectedSize)
+        return nullptr;
+
+    // Least recently used is judged by the modification time
+    entry.setLastModificationTime(juce::Time::getCurrentTime());
+
+    return std::make_unique<CachedReader>(std::move(map), header);
+}
+
+std::unique_ptr<juce::AudioFormatReader> DecodedAudioCache::store(const juce::String& key,
+    juce::AudioFormatReader& source,
+    juce::String* error)
+{
+    if (!cfg.directory.createDirectory())
+    {
+        if (error) *error = "Failed to create cache folder: " + cfg.directory.getFullPathName();
+        return nullptr;
+    }
+
+    const auto entry = getEntryFile(key);
+    juce::TemporaryFile temporary(entry);
+
+    {
+        juce::FileOutputStream stream(temporary.getFile());
+        if (stream.failedToOpen())
+        {
+            if (error) *error = "Failed to open cache entry: " + temporary.getFile().getFullPathName();
+            return nullptr;
+        }
+
+        Header header{};
+        std::memcpy(header.magic, entryMagic, 4);
+        header.version = currentVersion;
+        header.numChannels = source.numChannels;
+        header.sampleRate = source.sampleRate;
+        header.numSamples = source.lengthInSamples;
+
+        const int numChannels = static_cast<int>(source.numChannels);
+        const juce::int64 channelBytes = static_cast<juce::int64>(sizeof(float)) * header.numSamples;
+
+        bool ok = stream.write(&header, sizeof(Header));
+
+        // Channels are planar, so every decoded chunk goes to numChannels places of the file
+        juce::AudioBuffer<float> chunk(numChannels, decodeChunkSize);
+        for (juce::int64 pos = 0; ok && pos < header.numSamples; pos += decodeChunkSize)
+        {
+            const int n = static_cast<int>(std::min<juce::int64>(decodeChunkSize, header.numSamples - pos));
+            ok = source.read(&chunk, 0, n, pos, true, true);
+
+            for (int ch = 0; ok && ch < numChannels; ++ch)
+            {
+                const juce::int64 offset = static_cast<juce::int64>(sizeof(Header)) + ch * channelBytes
+                    + static_cast<juce::int64>(sizeof(float)) * pos;
+                ok = stream.setPosition(offset) && stream.write(chunk.getReadPointer(ch), sizeof(float) * static_cast<size_t>(n));
+            }
+        }
+
+        stream.flush();
+        if (!ok || stream.getStatus().failed())
+        {
+            if (error) *error = "Failed to write cache entry: " + temporary.getFile().getFullPathName();
+            return nullptr;
+        }
+    }
+
+    if (!temporary.overwriteTargetFileWithTemporary())
+    {
+        if (error) *error = "Failed to move cache entry to: " + entry.getFullPathName();
+        return nullptr;
+    }
+
+    enforceSizeLimit(entry);
+    return createReader(key);
+}
+
+//==============================================================================
+juce::File DecodedAudioCache::getEntryFile(const juce::String& key) const
+{
+    return cfg.directory.getChildFile(key + entryExtension);
+}
+
+void DecodedAudioCache::enforceSizeLimit(const juce::File& keep) const
+{
+    auto entries = cfg.directory.findChildFiles(juce::File::findFiles, false, juce::String("*") + entryExtension);
+
+    juce::int64 totalBytes = 0;
+    for (const auto& entry : entries)
+        totalBytes += entry.getSize();
+
+    // Oldest first
+    std::vector<juce::File> byAge(entries.begin(), entries.end());
+    std::sort(byAge.begin(), byAge.end(), [](const juce::File& a, const juce::File& b)
+        {
+            return a.getLastModificationTime() < b.getLastModificationTime();
+        });
+
+    for (const auto& entry : byAge)
+    {
+        if (totalBytes <= cfg.maxBytes)
+            break;
+
+        if (entry == keep)
+            continue;
+
+        const auto size = entry.getSize();
+        if (entry.deleteFile())
+            totalBytes -= size;
+    }
+}
@@ -0,0 +1,208 @@
+/*
+ * This file implements DerivedSignal, see DerivedSignal.h.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/DerivedSignal.h"
+#include "include/WindowedEnergy.h"
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+void DerivedSignal::reset(const juce::AudioBuffer<float>* newSignal, double fs, int newWindowSize, int newHopSize)
+{
+    signal = newSignal;
+    sampleRate = fs;
+    windowSize = newWindowSize;
+    hopSize = newHopSize;
+
+    hasWindows = false;
+    kWeightedMeanEnergy = 0.0f;
+    kWeightedWindowEnergies.clear();
+    windowRMS.clear();
+
+    hasDeltaHistogram = false;
+    hasDeltaPercentile = false;
+}
+
+void DerivedSignal::setExactPercentiles(bool shouldBeExact)
+{
+    exactPercentiles = shouldBeExact;
+    hasDeltaPercentile = false;
+}
+
+void DerivedSignal::prepareKWeighting(juce::dsp::IIR::Filter<float>& lowShelf,
+    juce::dsp::IIR::Filter<float>& highShelf,
+    double fs)
+{
+    lowShelf.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowShelf(
+        fs, 1681.974450955533, 0.7071752369554196, 1.53512485958697);
+    highShelf.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf(
+        fs, 424.318677406412, 0.7071752369554196, 1.0);
+    lowShelf.reset();
+    highShelf.reset();
+}
+
+//==============================================================================
+float DerivedSignal::getKWeightedMeanEnergy()
+{
+    computeWindows();
+    return kWeightedMeanEnergy;
+}
+
+const std::vector<float>& DerivedSignal::getKWeightedWindowEnergies()
+{
+    computeWindows();
+    return kWeightedWindowEnergies;
+}
+
+const std::vector<float>& DerivedSignal::getWindowRMS()
+{
+    computeWindows();
+    return windowRMS;
+}
+
+float DerivedSignal::getDeltaPercentile(float percentile)
+{
+    percentile = juce::jlimit(0.0f, 1.0f, percentile);
+
+    if (hasDeltaPercentile && deltaPercentileRank == percentile)
+        return deltaPercentile;
+
+    deltaPercentileRank = percentile;
+    hasDeltaPercentile = true;
+
+    if (exactPercentiles)
+    {
+        deltaPercentile = getExactDeltaPercentile(percentile);
+        return deltaPercentile;
+    }
+
+    computeDeltaHistogram();
+
+    const juce::uint64 count = deltaHistogram.getCount();
+    deltaPercentile = count > 0
+        ? deltaHistogram.getValueAtRank(static_cast<juce::uint64>(std::floor(percentile * static_cast<double>(count - 1))))
+        : 0.0f;
+    return deltaPercentile;
+}
+
+void DerivedSignal::computeDeltaHistogram()
+{
+    if (hasDeltaHistogram)
+        return;
+
+    hasDeltaHistogram = true;
+    deltaHistogram.reset();
+
+    if (signal == nullptr)
+        return;
+
+    const int numSamples = signal->getNumSamples();
+
+    for (int ch = 0; ch < signal->getNumChannels(); ++ch)
+    {
+        const float* x = signal->getReadPointer(ch);
+
+        for (int n = 1; n < numSamples; ++n)
+            deltaHistogram.add(std::abs(x[n] - x[n - 1]));
+    }
+}
+
+float DerivedSignal::getExactDeltaPercentile(float percentile) const
+{
+    const int numSamples = signal != nullptr ? signal->getNumSamples() : 0;
+    const int numChannels = signal != nullptr ? signal->getNumChannels() : 0;
+
+    if (numSamples < 2 || numChannels < 1)
+        return 0.0f;
+
+    std::vector<float> deltas;
+    deltas.reserve(static_cast<size_t>(numChannels) * static_cast<size_t>(numSamples - 1));
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* x = signal->getReadPointer(ch);
+
+        for (int n = 1; n < numSamples; ++n)
+            deltas.push_back(std::abs(x[n] - x[n - 1]));
+    }
+
+    const size_t last = deltas.size() - 1;
+    const size_t idx = static_cast<size_t>(std::floor(percentile * static_cast<float>(last)));
+
+    // nth_element gives the element that would be at idx in sorted order, without fully sorting
+    std::nth_element(deltas.begin(), deltas.begin() + static_cast<ptrdiff_t>(idx), deltas.end());
+
+    return deltas[idx];
+}
+
+// One pass for the windows of the signal and of its K-weighted version
+//==============================================================================
+void DerivedSignal::computeWindows()
+{
+    if (hasWindows)
+        return;
+
+    hasWindows = true;
+
+    if (signal == nullptr)
+        return;
+
+    const int numSamples = signal->getNumSamples();
+    const int numChannels = signal->getNumChannels();
+
+    WindowedEnergy windows, kWeightedWindows;
+    windows.prepare(windowSize, hopSize, numChannels);
+    kWeightedWindows.prepare(windowSize, hopSize, numChannels);
+
+    std::vector<juce::dsp::IIR::Filter<float>> lowShelf(static_cast<size_t>(numChannels));
+    std::vector<juce::dsp::IIR::Filter<float>> highShelf(static_cast<size_t>(numChannels));
+    for (size_t ch = 0; ch < lowShelf.size(); ++ch)
+        prepareKWeighting(lowShelf[ch], highShelf[ch], sampleRate);
+
+    juce::AudioBuffer<float> kWeighted(numChannels, std::min(chunkSize, juce::jmax(1, numSamples)));
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const int n = std::min(chunkSize, numSamples - start);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* x = signal->getReadPointer(ch, start);
+            float* y = kWeighted.getWritePointer(ch);
+            auto& low = lowShelf[static_cast<size_t>(ch)];
+            auto& high = highShelf[static_cast<size_t>(ch)];
+
+            for (int i = 0; i < n; ++i)
+                y[i] = high.processSample(low.processSample(x[i]));
+        }
+
+        windows.process(*signal, start, n);
+        kWeightedWindows.process(kWeighted, 0, n);
+    }
+
+    const double total = static_cast<double>(numSamples) * numChannels;
+    kWeightedMeanEnergy = total > 0.0 ? static_cast<float>(kWeightedWindows.getTotalEnergy() / total) : 0.0f;
+    kWeightedWindowEnergies = kWeightedWindows.getWindowEnergies();
+
+    const auto& energies = windows.getWindowEnergies();
+    windowRMS.resize(energies.size());
+    std::transform(energies.begin(), energies.end(), windowRMS.begin(),
+        [](float energy) { return std::sqrt(energy); });
+}
@@ -24,6 +24,7 @@
  */
 
 #include "include/Metrics.h"
+#include "include/MetricsAccumulator.h"
 #include <include_juce_dsp.cpp>
 #include <cmath>
 #include <numeric>
@@ -39,6 +40,23 @@ void Metrics::prepare(const double& fs)
     sampleRate = fs;
 }
 
+void Metrics::setNumThreads(int newNumThreads)
+{
+    numThreads = newNumThreads;
+}
+
+void Metrics::setExactPercentiles(bool shouldBeExact)
+{
+    exactPercentiles = shouldBeExact;
+}
+
+void Metrics::setWindowing(float windowSeconds, float hopSeconds)
+{
+    jassert(windowSeconds > 0.0f && hopSeconds > 0.0f);
+    windowDuration = windowSeconds;
+    hopDuration = hopSeconds;
+}
+
 //==============================================================================
 void Metrics::setUncompressedSignal(juce::AudioBuffer<float>* signal)
 {
@@ -94,77 +112,108 @@ void Metrics::extractMetrics()
         return;
     }
 
-    auto computeMetrics = [this](CompressionMetrics& metrics) {
+    // Derived data is computed on first use and shared, e.g. the reference by both comparisons
+    const int windowSize = static_cast<int>(windowDuration * sampleRate);
+    const int hopSize = static_cast<int>(hopDuration * sampleRate);
+    uncompressedDerived.reset(uncompressedMetrics.signal, sampleRate, windowSize, hopSize);
+    peakDerived.reset(peakMetrics.signal, sampleRate, windowSize, hopSize);
+    rmsDerived.reset(rmsMetrics.signal, sampleRate, windowSize, hopSize);
+
+    for (auto* derived : { &uncompressedDerived, &peakDerived, &rmsDerived })
+        derived->setExactPercentiles(exactPercentiles);
+
+    // Every task writes only its own fields, so the result doesn't depend on the thread count.
+    // The comparison task of a compressed signal waits for everything it reads of both signals.
+    taskGraph.clear();
+
+    struct SignalTasks
+    {
+        int level, loudness, transients;
+    };
+
+    auto addSignalTasks = [this](CompressionMetrics& metrics, DerivedSignal& derived) {
+
+        SignalTasks tasks;
+        const juce::String name(metrics.signalName);
+
+        // 1. Signal intensity, waveform distortion and gain reduction statistics in one pass
+        tasks.level = taskGraph.addTask(name + " / level", [this, &metrics]() {
+            MetricsAccumulator accumulator;
+            accumulator.prepare(metrics.signal->getNumChannels());
+            accumulator.process(metrics.signal,
+                metrics.isCompressed ? uncompressedMetrics.signal : nullptr,
+                metrics.isCompressed ? metrics.GRSignal : nullptr,
+                0, metrics.signal->getNumSamples());
+
+            metrics.meanEnergy = accumulator.getMeanEnergy();
+            metrics.peak = accumulator.getPeak();
+            metrics.rms = getRMSValue(metrics.meanEnergy);
+            metrics.crestFactor = getCrestFactor(metrics.peak, metrics.rms);
+
+            if (metrics.isCompressed) {
+                metrics.harmonicDistortion = accumulator.getWaveformDistortion();
+
+                const auto grStatistics = accumulator.getGainReductionStatistics(sampleRate);
+                metrics.avgGR = grStatistics.avgGR;
+                metrics.maxGR = grStatistics.maxGR;
+                metrics.stdDevGR = grStatistics.stdDevGR;
+                metrics.energyGR = grStatistics.energyGR;
+                metrics.rateOfChangeGR = grStatistics.rateOfChangeGR;
+                metrics.compressionActivityRatio = grStatistics.compressionActivityRatio;
+            }
+            });
+
+        // Also fills the window cache of derived for the transient energy preservation
+        tasks.loudness = taskGraph.addTask(name + " / loudness", [this, &metrics, &derived]() {
+            metrics.lufs = getLUFS(derived);
+            metrics.lra = getLRA(derived);
+            });
+
+        tasks.transients = taskGraph.addTask(name + " / transients", [this, &derived]() {
+            derived.getDeltaPercentile(transientPercentile);
+            });
 
-        
-        // 1. Signal instensity and dynamic range metrics
-        metrics.meanEnergy = getAverageEnergy(*metrics.signal);
-        metrics.peak = getPeakValue(*metrics.signal);
-        metrics.rms = getRMSValue(metrics.meanEnergy);
-        metrics.crestFactor = getCrestFactor(metrics.peak, metrics.rms);
-        metrics.lufs = getLUFS(*metrics.signal);
-        metrics.lra = getLRA(*metrics.signal);
+        return tasks;
+        };
+
+    const auto uncompressedTasks = addSignalTasks(uncompressedMetrics, uncompressedDerived);
+
+    auto addComparisonTask = [&](CompressionMetrics& metrics, DerivedSignal& derived) {
 
-        if (metrics.isCompressed) {
-            // 2. Compression impact metrics
+        const auto tasks = addSignalTasks(metrics, derived);
+
+        // 2. Compression impact metrics, only reading the caches filled above
+        taskGraph.addTask(juce::String(metrics.signalName) + " / comparison", [this, &metrics, &derived]() {
             metrics.dynamicRangeReductionCrest = getDynamicRangeReductionCrest(metrics.crestFactor);
             metrics.dynamicRangeReductionLRA = getDynamicRangeReductionLRA(metrics.lra);
-            metrics.transientImpact = getTransientImpact(*metrics.signal);
-            metrics.transientEnergyPreservation = getTransientEnergyPreservation(*metrics.signal);
-            metrics.harmonicDistortion = getWaveformDistortion(*metrics.signal);
-
-            // 3. Gain reduction metrics
-            metrics.avgGR = getAverageGainReduction(*metrics.GRSignal);
-            metrics.maxGR = getMaxGainReduction(*metrics.GRSignal);
-            metrics.stdDevGR = getStdDevGainReduction(*metrics.GRSignal, metrics.avgGR);
-            metrics.energyGR = getEnergyGainReduction(*metrics.GRSignal);
-            metrics.rateOfChangeGR = getRateOfChangeGainReduction(*metrics.GRSignal);
-            metrics.compressionActivityRatio = getCompressionActivityRatio(*metrics.GRSignal);
-        }
+            metrics.transientImpact = getTransientImpact(derived);
+            metrics.transientEnergyPreservation = getTransientEnergyPreservation(derived);
+            },
+            { uncompressedTasks.level, uncompressedTasks.loudness, uncompressedTasks.transients,
+              tasks.level, tasks.loudness, tasks.transients });
         };
 
-    computeMetrics(uncompressedMetrics);
-    computeMetrics(peakMetrics);
-    computeMetrics(rmsMetrics);
+    addComparisonTask(peakMetrics, peakDerived);
+    addComparisonTask(rmsMetrics, rmsDerived);
+
+    taskGraph.run(numThreads);
 }
 
-// 1. Signal intensity and dynamic range metrics
-//==============================================================================
-float Metrics::getPeakValue(const juce::AudioBuffer<float>& buffer)
+juce::String Metrics::formatTaskTimings() const
 {
-    const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
-
-    float peak = 0.0f;
-
-    for (int ch = 0; ch < numChannels; ++ch) {
-        const float* channelData = buffer.getReadPointer(ch);
-        for (int n = 0; n < numSamples; ++n) {
-            peak = std::max(peak, std::abs(channelData[n])); // Use absolute value here.
-        }
-    }
-    return peak; // in linear gain
+    return taskGraph.formatTimings("Metrics tasks");
 }
 
-float Metrics::getAverageEnergy(const juce::AudioBuffer<float>& buffer)
+Metrics::GainReductionStatistics Metrics::getGainReductionStatistics(const juce::AudioBuffer<float>& gainReductionSignal)
 {
-    const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
-
-    float meanSquare = 0.0f;
-    const float silenceThreshold = 0.0001f;
-
-    for (int ch = 0; ch < numChannels; ++ch) {
-        const float* channelData = buffer.getReadPointer(ch);
-        for (int n = 0; n < numSamples; ++n) {
-            if (std::abs(channelData[n]) >= silenceThreshold) {
-                meanSquare += channelData[n] * channelData[n];
-            }
-        }
-    }
-    return meanSquare / static_cast<float>(numSamples * numChannels); // in linear gain
+    MetricsAccumulator accumulator;
+    accumulator.prepare(gainReductionSignal.getNumChannels());
+    accumulator.process(nullptr, nullptr, &gainReductionSignal, 0, gainReductionSignal.getNumSamples());
+    return accumulator.getGainReductionStatistics(sampleRate);
 }
 
+// 1. Signal intensity and dynamic range metrics
+//==============================================================================
 float Metrics::getRMSValue(float meanSquare)
 {
     return std::sqrtf(meanSquare); // in linear gain
@@ -175,24 +224,30 @@ float Metrics::getCrestFactor(float peakValue, float rmsValue)
     return juce::Decibels::gainToDecibels(peakValue / rmsValue); // in db
 }
 
-float Metrics::getLUFS(const juce::AudioBuffer<float>& buffer)
+float Metrics::getLUFS(DerivedSignal& signal)
 {
-    // Copy the buffer and apply K-weighting
-    juce::AudioBuffer<float> kWeightedBuffer;
-    kWeightedBuffer.makeCopyOf(buffer);
-    applyKWeighting(kWeightedBuffer);
-
-    return getIntegratedLoudness(getAverageEnergy(kWeightedBuffer)); // in db
+    return getIntegratedLoudness(signal.getKWeightedMeanEnergy()); // in db
 }
 
-float Metrics::getLRA(const juce::AudioBuffer<float>& buffer)
+float Metrics::getLRA(DerivedSignal& signal)
 {
-    // Copy and apply K-weighting filters
-    juce::AudioBuffer<float> kWeightedBuffer;
-    kWeightedBuffer.makeCopyOf(buffer);
-    applyKWeighting(kWeightedBuffer);
+    if (!exactPercentiles)
+    {
+        const auto& windowEnergies = signal.getKWeightedWindowEnergies();
+        if (windowEnergies.empty())
+            return 0.0f;
+
+        // Loudness is monotonic in the energy, so the percentiles of the energies give the same
+        // ranks; the K-weighting correction cancels out in the difference
+        QuantileHistogram energies = QuantileHistogram::forWindowEnergies();
+        energies.add(windowEnergies.data(), static_cast<int>(windowEnergies.size()));
+
+        const juce::uint64 n = energies.getCount();
+        return juce::Decibels::gainToDecibels(energies.getValueAtRank(static_cast<juce::uint64>(0.95 * n)))
+            - juce::Decibels::gainToDecibels(energies.getValueAtRank(static_cast<juce::uint64>(0.1 * n))); // in db
+    }
 
-    std::vector<float> shortTermLoudness = getShortTermLoudness(kWeightedBuffer);
+    std::vector<float> shortTermLoudness = getShortTermLoudness(signal);
 
     // Step 2: Calculate LRA from short-term loudness
     if (shortTermLoudness.empty())
@@ -222,49 +277,12 @@ float Metrics::getDynamicRangeReductionLRA(float compressedLRA)
     return uncompressedMetrics.lra - compressedLRA; // in db
 }
 
-float Metrics::getTransientImpact(const juce::AudioBuffer<float>& compressedBuffer)
+float Metrics::getTransientImpact(DerivedSignal& compressedSignal)
 {
     constexpr float eps = 1.0e-12f;
 
-    auto computeTransientStrengthPercentile = [](const juce::AudioBuffer<float>& buffer,
-        float pct) -> float
-        {
-            const int numSamples = buffer.getNumSamples();
-            const int numChannels = buffer.getNumChannels();
-
-            if (numSamples < 2 || numChannels < 1)
-                return 0.0f;
-
-            std::vector<float> deltas;
-            deltas.reserve((size_t)numChannels * (size_t)(numSamples - 1));
-
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                const float* x = buffer.getReadPointer(ch);
-
-                for (int n = 1; n < numSamples; ++n)
-                    deltas.push_back(std::abs(x[n] - x[n - 1]));
-            }
-
-            if (deltas.empty())
-                return 0.0f;
-
-            pct = juce::jlimit(0.0f, 1.0f, pct);
-
-            const size_t last = deltas.size() - 1;
-            const size_t idx = (size_t)std::floor(pct * (float)last);
-
-            // nth_element gives the element that would be at idx in sorted order, without fully sorting
-            std::nth_element(deltas.begin(), deltas.begin() + (ptrdiff_t)idx, deltas.end());
-
-            return deltas[idx]; // linear
-        };
-
-    const float uncompressedStrength =
-        computeTransientStrengthPercentile(*uncompressedMetrics.signal, transientPercentile);
-
-    const float compressedStrength =
-        computeTransientStrengthPercentile(compressedBuffer, transientPercentile);
+    const float uncompressedStrength = uncompressedDerived.getDeltaPercentile(transientPercentile);
+    const float compressedStrength = compressedSignal.getDeltaPercentile(transientPercentile);
 
     if (uncompressedStrength <= eps)
         return 0.0f; // nothing to compare (silent or constant)
@@ -281,31 +299,16 @@ float Metrics::getTransientImpact(const juce::AudioBuffer<float>& compressedBuff
 }
 
 
-float Metrics::getTransientEnergyPreservation(const juce::AudioBuffer<float>& compressedBuffer)
+float Metrics::getTransientEnergyPreservation(DerivedSignal& compressedSignal)
 {
-    // Split both signals into short-time windows
-    std::vector<juce::AudioBuffer<float>> uncompressedWindows = getWindowsFromBuffer(*uncompressedMetrics.signal);
-    std::vector<juce::AudioBuffer<float>> compressedWindows = getWindowsFromBuffer(compressedBuffer);
+    // Short-term RMS (linear) of every window of both signals
+    const std::vector<float>& uncompressedRMS = uncompressedDerived.getWindowRMS();
+    const std::vector<float>& compressedRMS = compressedSignal.getWindowRMS();
 
-    if (uncompressedWindows.empty() || uncompressedWindows.size() != compressedWindows.size())
+    if (uncompressedRMS.empty() || uncompressedRMS.size() != compressedRMS.size())
         return 0.0f;
 
-    const size_t numWindows = uncompressedWindows.size();
-
-    std::vector<float> uncompressedRMS;
-    std::vector<float> compressedRMS;
-    uncompressedRMS.reserve(numWindows);
-    compressedRMS.reserve(numWindows);
-
-    // Compute short-term RMS (linear) for each window
-    for ( size_t k = 0; k < numWindows; ++k)
-    {
-        const float rmsUncompressed = getRMSValue(getAverageEnergy(uncompressedWindows[k]));
-        const float rmsCompressed = getRMSValue(getAverageEnergy(compressedWindows[k]));
-
-        uncompressedRMS.push_back(rmsUncompressed);
-        compressedRMS.push_back(rmsCompressed);
-    }
+    const size_t numWindows = uncompressedRMS.size();
 
     // Mean short-term RMS of the uncompressed signal
     const float sumUncompressedRMS = std::accumulate(uncompressedRMS.begin(),
@@ -351,196 +354,6 @@ float Metrics::getTransientEnergyPreservation(const juce::AudioBuffer<float>& co
     return ratio;
 }
 
-float Metrics::getWaveformDistortion(const juce::AudioBuffer<float>& compressedBuffer)
-{
-    const int numSamples = compressedBuffer.getNumSamples();
-    const int numChannels = compressedBuffer.getNumChannels();
-
-    const auto& originalBuffer = *uncompressedMetrics.signal;
-    double originalEnergySum = 0.0;
-    double errorEnergySum = 0.0;
-
-    for (int ch = 0; ch < numChannels; ++ch)
-    {
-        const float* originalData = originalBuffer.getReadPointer(ch);
-        const float* compressedData = compressedBuffer.getReadPointer(ch);
-
-        for (int n = 0; n < numSamples; ++n)
-        {
-            const float x_u = originalData[n];
-            const float x_c = compressedData[n];
-            const float error = x_u - x_c;
-
-            originalEnergySum += static_cast<double>(x_u) * static_cast<double>(x_u);
-            errorEnergySum += static_cast<double>(error) * static_cast<double>(error);
-        }
-    }
-
-    const int totalCount = numChannels * numSamples;
-    if (totalCount <= 0)
-        return 0.0f;
-
-    const double originalMeanSquare = originalEnergySum / static_cast<double>(totalCount);
-    const double errorMeanSquare = errorEnergySum / static_cast<double>(totalCount);
-
-    const double originalRms = std::sqrt(originalMeanSquare);
-    const double errorRms = std::sqrt(errorMeanSquare);
-
-    const double eps = 1.0e-9;
-    if (originalRms <= eps)
-        return 0.0f;
-
-    const double distortion = errorRms / originalRms;
-    return static_cast<float>(distortion);
-}
-
-// 3. Gain reduction metrics
-//==============================================================================
-float Metrics::getMaxGainReduction(const juce::AudioBuffer<float>& gainReductionBuffer) const
-{
-    const int numSamples = gainReductionBuffer.getNumSamples();
-    const int numChannels = gainReductionBuffer.getNumChannels();
-
-    float maxReduction = 0.0f;
-
-    for (int ch = 0; ch < numChannels; ++ch) {
-        const float* channelData = gainReductionBuffer.getReadPointer(ch);
-        for (int n = 0; n < numSamples; ++n) {
-            const float reduction = juce::Decibels::gainToDecibels(channelData[n]);
-            if (reduction == -100.0f) { continue; } // ignore silence
-            maxReduction = std::min(maxReduction, reduction); // Track max = min reduction
-        }
-    }
-    return std::abs(maxReduction); // in db
-}
-
-float Metrics::getAverageGainReduction(const juce::AudioBuffer<float>& gainReductionBuffer) const
-{
-    const int numSamples = gainReductionBuffer.getNumSamples();
-    const int numChannels = gainReductionBuffer.getNumChannels();
-
-    float totalGainReduction = 0.0f;
-
-    for (int ch = 0; ch < numChannels; ++ch) {
-        const float* channelData = gainReductionBuffer.getReadPointer(ch);
-        for (int n = 0; n < numSamples; ++n) {
-            const float reduction = juce::Decibels::gainToDecibels(channelData[n]);
-            if (reduction == -100.0f) { continue; } // ignore silence
-            totalGainReduction += std::fabs(reduction);   // Sum absolute reductions
-        }
-    }
-    return totalGainReduction / (numSamples * numChannels); // in db
-}
-
-float Metrics::getStdDevGainReduction(const juce::AudioBuffer<float>& gainReductionBuffer, float mean)
-{
-    const int numSamples = gainReductionBuffer.getNumSamples();
-    const int numChannels = gainReductionBuffer.getNumChannels();
-
-    float sum = 0.0f;
-
-    // Step 2: Compute the sum of squared deviations from the mean
-    for (int ch = 0; ch < numChannels; ++ch) {
-        const float* channelData = gainReductionBuffer.getReadPointer(ch);
-        for (int n = 0; n < numSamples; ++n) {
-            const float deviation = channelData[n] - mean;
-            sum += deviation * deviation;
-        }
-    }
-    return std::sqrt(sum / (numSamples * numChannels));
-}
-
-float Metrics::getEnergyGainReduction(const juce::AudioBuffer<float>& gainReductionBuffer)
-{
-    return std::abs(juce::Decibels::gainToDecibels(getAverageEnergy(gainReductionBuffer))); // in db
-}
-
-float Metrics::getRateOfChangeGainReduction(const juce::AudioBuffer<float>& gainReductionBuffer)
-{
-    const int numSamples = gainReductionBuffer.getNumSamples();
-    const int numChannels = gainReductionBuffer.getNumChannels();
-
-    float sumRateOfChange = 0.0f;
-
-    for (int ch = 0; ch < numChannels; ++ch) {
-        const float* channelData = gainReductionBuffer.getReadPointer(ch);
-        for (int n = 1; n < numSamples; ++n) {
-            sumRateOfChange += std::abs(channelData[n] - channelData[n - 1]);
-        }
-    }
-    return (sumRateOfChange / ((numSamples - 1) * numChannels)) * sampleRate;
-}
-
-float Metrics::getCompressionActivityRatio(const juce::AudioBuffer<float>& gainReductionBuffer)
-{
-    const int numSamples = gainReductionBuffer.getNumSamples();
-    const int numChannels = gainReductionBuffer.getNumChannels();
-
-    int activeSamples = 0;
-
-    for (int ch = 0; ch < numChannels; ++ch) {
-        const float* channelData = gainReductionBuffer.getReadPointer(ch);
-        for (int n = 0; n < numSamples; ++n) {
-            if (juce::Decibels::gainToDecibels(channelData[n]) < 0.0f) {
-                ++activeSamples;
-            }
-        }
-    }
-    return static_cast<float>(activeSamples) / (numSamples * numChannels);
-}
-
-
-// Signal modifications
-//==============================================================================
-
-// Modifies input buffer for LUFS and LRA calculations by K-weighting
-void Metrics::applyKWeighting(juce::AudioBuffer<float>& buffer)
-{
-    // Create the K-weighting filters
-    juce::dsp::IIR::Filter<float> lowShelfFilter, highShelfFilter;
-
-    // Configure filter coefficients
-    lowShelfFilter.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowShelf(
-        sampleRate, 1681.974450955533, 0.7071752369554196, 1.53512485958697);
-    highShelfFilter.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-        sampleRate, 424.318677406412, 0.7071752369554196, 1.0);
-
-    // Convert the buffer into a JUCE AudioBlock
-    juce::dsp::AudioBlock<float> audioBlock(buffer);
-
-    for (size_t ch = 0; ch < static_cast<size_t>(audioBlock.getNumChannels()); ++ch) {
-        auto singleChannelBlock = audioBlock.getSingleChannelBlock(ch);
-        juce::dsp::ProcessContextReplacing<float> context(singleChannelBlock);
-
-        // Apply the filters
-        lowShelfFilter.process(context);  // Apply low-shelf filter
-        highShelfFilter.process(context); // Apply high-shelf filter
-    }
-}
-
-// Create windows for short-term calculations
-std::vector<juce::AudioBuffer<float>> Metrics::getWindowsFromBuffer(const juce::AudioBuffer<float>& buffer)
-{
-    const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
-
-    const int windowSize = static_cast<int>(windowDuration * sampleRate);
-    const int hopSize = static_cast<int>(hopDuration * sampleRate);
-
-    std::vector<juce::AudioBuffer<float>> windowsBuffers;
-
-    for (int startSample = 0; startSample + windowSize <= numSamples; startSample += hopSize) {
-        juce::AudioBuffer<float> windowBuffer(numChannels, windowSize);
-        for (int ch = 0; ch < numChannels; ++ch) {
-            const float* source = buffer.getReadPointer(ch, startSample);
-            float* dest = windowBuffer.getWritePointer(ch);
-            std::copy(source, source + windowSize, dest);
-        }
-        windowsBuffers.push_back(std::move(windowBuffer));
-    }
-    return windowsBuffers;
-}
-
 // Additional computation for LUFS and LRA
 //==============================================================================
 float Metrics::getIntegratedLoudness(float meanEnergy)
@@ -548,17 +361,15 @@ float Metrics::getIntegratedLoudness(float meanEnergy)
     return juce::Decibels::gainToDecibels(meanEnergy) - 0.691f; // K-weighting correction, in db
 }
 
-std::vector<float> Metrics::getShortTermLoudness(juce::AudioBuffer<float>& buffer)
+std::vector<float> Metrics::getShortTermLoudness(DerivedSignal& signal)
 {
-    // Step 1: Extract all windows from the buffer
-    std::vector<juce::AudioBuffer<float>> windowBuffers = getWindowsFromBuffer(buffer);
-    std::vector<float> shortTermLoudness;
-
-    // Step 2: Iterate over each window and calculate loudness
-    for (const auto& windowBuffer : windowBuffers) {
-        const float shortTermloudness = getIntegratedLoudness(getAverageEnergy(windowBuffer));
-        shortTermLoudness.push_back(shortTermloudness);
-    }
+    // Step 1: Mean energy of every window of the K-weighted signal
+    std::vector<float> shortTermLoudness = signal.getKWeightedWindowEnergies();
+
+    // Step 2: Convert each window energy into loudness
+    for (auto& loudness : shortTermLoudness)
+        loudness = getIntegratedLoudness(loudness);
+
     return shortTermLoudness; // in db
 }
 
@@ -0,0 +1,286 @@
+/*
+ * This file implements MetricsAccumulator, see MetricsAccumulator.h.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/MetricsAccumulator.h"
+#include "../dsp/include/FastMath.h"
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+void MetricsAccumulator::prepare(int channels)
+{
+    *this = {};
+    numChannels = channels;
+    firstGain.assign(static_cast<size_t>(numChannels), 1.0f);
+    lastGain.assign(static_cast<size_t>(numChannels), 1.0f);
+    decibels.resize(static_cast<size_t>(blockSize));
+}
+
+void MetricsAccumulator::process(const juce::AudioBuffer<float>* signal,
+    const juce::AudioBuffer<float>* reference,
+    const juce::AudioBuffer<float>* gainReduction,
+    int startSample,
+    int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (signal != nullptr)
+            processSignal(signal->getReadPointer(ch, startSample),
+                reference != nullptr ? reference->getReadPointer(ch, startSample) : nullptr,
+                numSamples);
+
+        if (gainReduction != nullptr)
+        {
+            const float* gain = gainReduction->getReadPointer(ch, startSample);
+            processGainReduction(gain, lastGain[static_cast<size_t>(ch)], hasGain, numSamples);
+
+            if (!hasGain)
+                firstGain[static_cast<size_t>(ch)] = gain[0];
+            lastGain[static_cast<size_t>(ch)] = gain[numSamples - 1];
+        }
+    }
+
+    hasGain = hasGain || gainReduction != nullptr;
+    numFrames += numSamples;
+}
+
+void MetricsAccumulator::merge(const MetricsAccumulator& following)
+{
+    jassert(following.numChannels == numChannels);
+
+    energy += following.energy;
+    peak = std::max(peak, following.peak);
+    referenceEnergy += following.referenceEnergy;
+    errorEnergy += following.errorEnergy;
+
+    sumAbsDecibels += following.sumAbsDecibels;
+    minGain = std::min(minGain, following.minGain);
+    sumGain += following.sumGain;
+    sumGainSquared += following.sumGainSquared;
+    gatedGainEnergy += following.gatedGainEnergy;
+    sumAbsChange += following.sumAbsChange;
+    numActive += following.numActive;
+
+    if (following.hasGain)
+    {
+        for (size_t ch = 0; ch < lastGain.size(); ++ch)
+        {
+            // The change from the last gain of this part to the first one of the following part
+            if (hasGain)
+                sumAbsChange += std::abs(following.firstGain[ch] - lastGain[ch]);
+            else
+                firstGain[ch] = following.firstGain[ch];
+
+            lastGain[ch] = following.lastGain[ch];
+        }
+        hasGain = true;
+    }
+
+    numFrames += following.numFrames;
+}
+
+// Single pass kernels
+//==============================================================================
+void MetricsAccumulator::processSignal(const float* x, const float* reference, int numSamples)
+{
+    for (int blockStart = 0; blockStart < numSamples; blockStart += blockSize)
+    {
+        const int n = std::min(blockSize, numSamples - blockStart);
+        const float* s = x + blockStart;
+
+        float blockEnergy[numLanes] = {};
+        float blockPeak[numLanes] = {};
+
+        int i = 0;
+        for (; i + numLanes <= n; i += numLanes)
+        {
+            for (int l = 0; l < numLanes; ++l)
+            {
+                const float sample = s[i + l];
+                const float magnitude = std::abs(sample);
+                blockEnergy[l] += magnitude >= silenceThreshold ? sample * sample : 0.0f;
+                blockPeak[l] = std::max(blockPeak[l], magnitude);
+            }
+        }
+        for (; i < n; ++i)
+        {
+            const float magnitude = std::abs(s[i]);
+            blockEnergy[0] += magnitude >= silenceThreshold ? s[i] * s[i] : 0.0f;
+            blockPeak[0] = std::max(blockPeak[0], magnitude);
+        }
+
+        for (int l = 0; l < numLanes; ++l)
+        {
+            energy += blockEnergy[l];
+            peak = std::max(peak, blockPeak[l]);
+        }
+
+        if (reference == nullptr)
+            continue;
+
+        const float* r = reference + blockStart;
+        float blockReferenceEnergy[numLanes] = {};
+        float blockErrorEnergy[numLanes] = {};
+
+        i = 0;
+        for (; i + numLanes <= n; i += numLanes)
+        {
+            for (int l = 0; l < numLanes; ++l)
+            {
+                const float error = r[i + l] - s[i + l];
+                blockReferenceEnergy[l] += r[i + l] * r[i + l];
+                blockErrorEnergy[l] += error * error;
+            }
+        }
+        for (; i < n; ++i)
+        {
+            const float error = r[i] - s[i];
+            blockReferenceEnergy[0] += r[i] * r[i];
+            blockErrorEnergy[0] += error * error;
+        }
+
+        for (int l = 0; l < numLanes; ++l)
+        {
+            referenceEnergy += blockReferenceEnergy[l];
+            errorEnergy += blockErrorEnergy[l];
+        }
+    }
+}
+
+void MetricsAccumulator::processGainReduction(const float* gain, float previousGain, bool hasPreviousGain, int numSamples)
+{
+    if (hasPreviousGain)
+        sumAbsChange += std::abs(gain[0] - previousGain);
+
+    for (int blockStart = 0; blockStart < numSamples; blockStart += blockSize)
+    {
+        const int n = std::min(blockSize, numSamples - blockStart);
+        const float* g = gain + blockStart;
+        const float* db = decibels.data();
+
+        FastMath::gainToDecibels(g, decibels.data(), n);
+
+        float blockAbsDecibels[numLanes] = {};
+        float blockMinGain[numLanes];
+        float blockGain[numLanes] = {};
+        float blockGainSquared[numLanes] = {};
+        float blockGatedEnergy[numLanes] = {};
+        float blockActive[numLanes] = {};
+        float blockChange[numLanes] = {};
+        std::fill(blockMinGain, blockMinGain + numLanes, 1.0f);
+
+        // Changes within the block, g[-1] is the last gain of the previous block
+        const int firstChange = blockStart == 0 ? 1 : 0;
+
+        int i = 0;
+        for (; i + numLanes <= n; i += numLanes)
+        {
+            for (int l = 0; l < numLanes; ++l)
+            {
+                const float value = g[i + l];
+                const bool audible = value > silentGain;
+
+                blockAbsDecibels[l] += audible ? std::abs(db[i + l]) : 0.0f;
+                blockMinGain[l] = audible ? std::min(blockMinGain[l], value) : blockMinGain[l];
+                blockGain[l] += value;
+                blockGainSquared[l] += value * value;
+                blockGatedEnergy[l] += std::abs(value) >= silenceThreshold ? value * value : 0.0f;
+                blockActive[l] += value < 1.0f ? 1.0f : 0.0f;
+            }
+        }
+        for (; i < n; ++i)
+        {
+            const float value = g[i];
+            const bool audible = value > silentGain;
+
+            blockAbsDecibels[0] += audible ? std::abs(db[i]) : 0.0f;
+            blockMinGain[0] = audible ? std::min(blockMinGain[0], value) : blockMinGain[0];
+            blockGain[0] += value;
+            blockGainSquared[0] += value * value;
+            blockGatedEnergy[0] += std::abs(value) >= silenceThreshold ? value * value : 0.0f;
+            blockActive[0] += value < 1.0f ? 1.0f : 0.0f;
+        }
+
+        i = firstChange;
+        for (; i + numLanes <= n; i += numLanes)
+            for (int l = 0; l < numLanes; ++l)
+                blockChange[l] += std::abs(g[i + l] - g[i + l - 1]);
+        for (; i < n; ++i)
+            blockChange[0] += std::abs(g[i] - g[i - 1]);
+
+        for (int l = 0; l < numLanes; ++l)
+        {
+            sumAbsDecibels += blockAbsDecibels[l];
+            minGain = std::min(minGain, blockMinGain[l]);
+            sumGain += blockGain[l];
+            sumGainSquared += blockGainSquared[l];
+            gatedGainEnergy += blockGatedEnergy[l];
+            sumAbsChange += blockChange[l];
+            numActive += static_cast<juce::int64>(blockActive[l]);
+        }
+    }
+}
+
+// Results
+//==============================================================================
+float MetricsAccumulator::getMeanEnergy() const
+{
+    const double total = static_cast<double>(numFrames) * numChannels;
+    return total > 0.0 ? static_cast<float>(energy / total) : 0.0f;
+}
+
+float MetricsAccumulator::getWaveformDistortion() const
+{
+    const double total = static_cast<double>(numFrames) * numChannels;
+    if (total <= 0.0)
+        return 0.0f;
+
+    const double referenceRms = std::sqrt(referenceEnergy / total);
+    const double errorRms = std::sqrt(errorEnergy / total);
+
+    return referenceRms > 1.0e-9 ? static_cast<float>(errorRms / referenceRms) : 0.0f;
+}
+
+Metrics::GainReductionStatistics MetricsAccumulator::getGainReductionStatistics(double sampleRate) const
+{
+    Metrics::GainReductionStatistics statistics;
+
+    const double total = static_cast<double>(numFrames) * numChannels;
+    if (total <= 0.0)
+        return statistics;
+
+    // Deviation of the linear gains from the mean in dB, expanded so no second pass is needed
+    const double mean = sumAbsDecibels / total;
+    const double variance = (sumGainSquared - 2.0 * mean * sumGain + total * mean * mean) / total;
+
+    statistics.avgGR = static_cast<float>(mean);
+    statistics.maxGR = std::abs(juce::Decibels::gainToDecibels(minGain));
+    statistics.stdDevGR = static_cast<float>(std::sqrt(std::max(0.0, variance)));
+    statistics.energyGR = std::abs(juce::Decibels::gainToDecibels(static_cast<float>(gatedGainEnergy / total)));
+    statistics.rateOfChangeGR = numFrames > 1
+        ? static_cast<float>(sumAbsChange / (static_cast<double>(numFrames - 1) * numChannels) * sampleRate)
+        : 0.0f;
+    statistics.compressionActivityRatio = static_cast<float>(static_cast<double>(numActive) / total);
+
+    return statistics;
+}
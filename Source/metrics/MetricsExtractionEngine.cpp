@@ -3,87 +3,271 @@
 // Include your actual headers here
 #include "../dsp/include/Compressor.h"
 #include "include/Metrics.h"
+#include "include/StagePipeline.h"
+#include <cstring>
 
 MetricsExtractionEngine::MetricsExtractionEngine(AudioFileLoader& l,
     DataExport& e,
     Compressor& peak,
     Compressor& rms,
     Metrics& m,
-    juce::AudioProcessorValueTreeState& state,
+    ParameterSource source,
     Config c)
     : loader(l),
     exporter(e),
     peakCompressor(peak),
     rmsCompressor(rms),
     metrics(m),
-    apvts(state),
+    parameterSource(std::move(source)),
     cfg(std::move(c))
 {
 }
 
-void MetricsExtractionEngine::run(const juce::File& file)
+bool MetricsExtractionEngine::run(const juce::File& file, juce::String* error)
 {
     processing = true;
     progress = 0.0;
 
     selectedFile = file;
+    bool succeeded = false;
 
     try
     {
         // Check if selected file exists
         if (selectedFile == juce::File{} || !selectedFile.existsAsFile())
         {
+            if (error) *error = "File does not exist: " + selectedFile.getFullPathName();
             processing = false;
-            return;
+            return false;
         }
 
-        juce::String err; // error message in case the extraction fails at some point
-
-        // Load full audio file
-        auto loaded = loader.loadAudioFile(selectedFile, &err);
-        if (!loaded.has_value())
-            throw std::runtime_error(err.toStdString());
-
-        uncompressedSignal = std::move(loaded->buffer);
-        fileSampleRate = loaded->sampleRate;
-
-        progress = 0.3;
-
-        // Offline compression stage (chunked)
-        compressAudioFile();
-
-        progress = 0.6;
-
-        // Metrics computation stage
-        getMetrics();
-
-        progress = 0.8;
-
-        // Build report text
-        const auto report = buildMetricsReport();
-
-        // Export stage (DataExport owns folder/naming/writing)
-        const juce::AudioBuffer<float>* peakPtr = &peakCompressedSignal;
-        const juce::AudioBuffer<float>* rmsPtr = &rmsCompressedSignal;
-
-        if (!exporter.exportAll(selectedFile, report, peakPtr, rmsPtr, fileSampleRate, &err))
-            throw std::runtime_error(err.toStdString());
+        if (cfg.streaming)
+            runStreaming();
+        else
+            runInMemory();
 
         progress = 1.0;
+        succeeded = true;
     }
     catch (const std::exception& e)
     {
         DBG("Metrics extraction failed: " + juce::String(e.what()));
+        if (error) *error = e.what();
     }
     catch (...)
     {
         DBG("Unknown error during metrics extraction.");
+        if (error) *error = "Unknown error during metrics extraction.";
     }
 
     processing = false;
+    return succeeded;
 }
 
 
+void MetricsExtractionEngine::runInMemory()
+{
+    juce::String err; // error message in case the extraction fails at some point
+
+    // Load full audio file
+    auto loaded = loader.loadAudioFile(selectedFile, &err, 60.0 * cfg.maxDurationMinutes);
+    if (!loaded.has_value())
+        throw std::runtime_error(err.toStdString());
+
+    uncompressedSignal = std::move(loaded->buffer);
+    fileSampleRate = loaded->sampleRate;
+
+    progress = 0.3;
+
+    // Offline compression stage (chunked)
+    compressAudioFile();
+
+    progress = 0.6;
+
+    // Metrics computation stage
+    getMetrics();
+
+    progress = 0.8;
+
+    // Build report text
+    auto report = buildMetricsReport(metrics.getUncompressedMetrics(), metrics.getPeakMetrics(), metrics.getRMSMetrics());
+    report << "\n" << metrics.formatTaskTimings();
+
+    // Export stage (DataExport owns folder/naming/writing)
+    const juce::AudioBuffer<float>* peakPtr = &peakCompressedSignal;
+    const juce::AudioBuffer<float>* rmsPtr = &rmsCompressedSignal;
+
+    if (!exporter.exportAll(selectedFile, report, peakPtr, rmsPtr, fileSampleRate, &err))
+        throw std::runtime_error(err.toStdString());
+}
+
+void MetricsExtractionEngine::runStreaming()
+{
+    juce::String err;
+
+    auto reader = loader.createReader(selectedFile, &err);
+    if (!reader)
+        throw std::runtime_error(err.toStdString());
+
+    fileSampleRate = reader->sampleRate;
+    const int numChannels = static_cast<int>(reader->numChannels);
+    const juce::int64 length = reader->lengthInSamples;
+    const int chunkSize = cfg.chunkSize;
+
+    peakParallelReport = {};
+    rmsParallelReport = {};
+    peakControlRateReport = {};
+    rmsControlRateReport = {};
+
+    const juce::dsp::ProcessSpec spec{ fileSampleRate, static_cast<uint32_t>(chunkSize), static_cast<uint32_t>(numChannels) };
+    peakCompressor.prepareForMetricsExtraction(spec);
+    rmsCompressor.prepareForMetricsExtraction(spec);
+
+    // Both compressors share the lookahead, so one delay aligns the input with both outputs
+    const int latency = peakCompressor.getLatencySamples();
+    jassert(latency == rmsCompressor.getLatencySamples());
+
+    // Writers are closed (and the WAV headers finalized) when they go out of scope
+    std::unique_ptr<juce::AudioFormatWriter> peakWriter, rmsWriter;
+    if (exporter.isExportingWavs())
+    {
+        peakWriter = exporter.createWavWriter(selectedFile, "Peak_compressed", fileSampleRate, numChannels, &err);
+        if (peakWriter)
+            rmsWriter = exporter.createWavWriter(selectedFile, "RMS_compressed", fileSampleRate, numChannels, &err);
+        if (!peakWriter || !rmsWriter)
+            throw std::runtime_error(err.toStdString());
+    }
+
+    streamingMetrics.setWindowing(cfg.windowSeconds, cfg.hopSeconds);
+    streamingMetrics.prepare(fileSampleRate, numChannels);
+
+    // With latency, output sample p comes out when input sample p + latency goes in,
+    // so the input runs latency samples further (zero padded past the end of the file)
+    const juce::int64 end = length + latency;
+    const juce::int64 numChunks = (end + chunkSize - 1) / chunkSize;
+
+    StagePipeline pipeline(cfg.pipelined ? cfg.pipelineDepth : 1);
+
+    std::vector<StreamingChunk> slots(static_cast<size_t>(pipeline.getNumSlots()));
+    for (auto& slot : slots)
+        for (auto* buffer : { &slot.reference, &slot.peak, &slot.peakGR, &slot.rms, &slot.rmsGR })
+            buffer->setSize(numChannels, chunkSize);
+
+    // The input is read behind the last latency samples of the previous chunk, so the first n
+    // samples of history are the input delayed by latency, aligned with the compressor output
+    juce::AudioBuffer<float> history(numChannels, latency + chunkSize);
+    history.clear();
+
+    const int decode = pipeline.addStage("Decode", [&](int s, juce::int64 chunkIndex, juce::String& error)
+        {
+            auto& chunk = slots[static_cast<size_t>(s)];
+            const juce::int64 pos = chunkIndex * chunkSize;
+            const int n = static_cast<int>(std::min<juce::int64>(chunkSize, end - pos));
+
+            // Past the end of the file the input is zero padded (memory mapped readers can't read there)
+            const int available = static_cast<int>(juce::jlimit<juce::int64>(0, n, length - pos));
+            if (available > 0 && !reader->read(&history, latency, available, pos, true, true))
+            {
+                error = "Failed to read from: " + selectedFile.getFullPathName();
+                return false;
+            }
+            history.clear(latency + available, n - available);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                chunk.reference.copyFrom(ch, 0, history, ch, 0, n);
+                chunk.peak.copyFrom(ch, 0, history, ch, latency, n);
+                chunk.rms.copyFrom(ch, 0, history, ch, latency, n);
+
+                // Keep the last latency input samples for the next chunk
+                float* channel = history.getWritePointer(ch);
+                std::memmove(channel, channel + n, sizeof(float) * static_cast<size_t>(latency));
+            }
+
+            // Part of the chunk that belongs to the file, output sample k is file sample pos - latency + k
+            chunk.numSamples = n;
+            chunk.outputStart = static_cast<int>(std::max<juce::int64>(0, latency - pos));
+            chunk.outputEnd = static_cast<int>(std::min<juce::int64>(n, length + latency - pos));
+            return true;
+        });
+
+    auto compress = [&](Compressor& compressor, bool isRMS)
+        {
+            return [&slots, numChannels, c = &compressor, isRMS](int s, juce::int64, juce::String&)
+                {
+                    auto& compressor = *c;
+                    auto& chunk = slots[static_cast<size_t>(s)];
+                    auto& output = isRMS ? chunk.rms : chunk.peak;
+                    auto& gainReduction = isRMS ? chunk.rmsGR : chunk.peakGR;
+
+                    juce::AudioBuffer<float> view(output.getArrayOfWritePointers(), numChannels, chunk.numSamples);
+                    if (isRMS) compressor.applyRMSCompression(view, chunk.numSamples, numChannels, true);
+                    else       compressor.applyPeakCompression(view, chunk.numSamples, numChannels, true);
+
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        gainReduction.copyFrom(ch, 0, compressor.getGainReductionSignal(), ch, 0, chunk.numSamples);
+                    return true;
+                };
+        };
+
+    const int peakStage = pipeline.addStage("Peak compression", compress(peakCompressor, false), { decode });
+    const int rmsStage = pipeline.addStage("RMS compression", compress(rmsCompressor, true), { decode });
+
+    // Metrics and writing only read the chunk, so they run side by side
+    pipeline.addStage("Metrics", [&](int s, juce::int64, juce::String&)
+        {
+            const auto& chunk = slots[static_cast<size_t>(s)];
+            if (chunk.outputEnd > chunk.outputStart)
+                streamingMetrics.process(chunk.reference, chunk.peak, chunk.peakGR, chunk.rms, chunk.rmsGR,
+                    chunk.outputStart, chunk.outputEnd - chunk.outputStart);
+            return true;
+        }, { peakStage, rmsStage });
+
+    pipeline.addStage("Write", [&](int s, juce::int64 chunkIndex, juce::String& error)
+        {
+            const auto& chunk = slots[static_cast<size_t>(s)];
+            const int count = chunk.outputEnd - chunk.outputStart;
+
+            if (count > 0)
+            {
+                if (peakWriter != nullptr && !peakWriter->writeFromAudioSampleBuffer(chunk.peak, chunk.outputStart, count))
+                {
+                    error = "Failed to write the peak compressed signal.";
+                    return false;
+                }
+                if (rmsWriter != nullptr && !rmsWriter->writeFromAudioSampleBuffer(chunk.rms, chunk.outputStart, count))
+                {
+                    error = "Failed to write the rms compressed signal.";
+                    return false;
+                }
+            }
+
+            progress = 0.9 * static_cast<double>(chunkIndex + 1) / static_cast<double>(numChunks);
+            return true;
+        }, { peakStage, rmsStage });
+
+    const bool succeeded = cfg.pipelined ? pipeline.run(numChunks, &err) : pipeline.runSerially(numChunks, &err);
+
+    peakWriter.reset();
+    rmsWriter.reset();
+
+    // Back to real time processing compressor settings after the compression is finished
+    peakCompressor.prepareForRealTimeProcessing();
+    rmsCompressor.prepareForRealTimeProcessing();
+
+    if (!succeeded)
+        throw std::runtime_error(err.toStdString());
+
+    Metrics::CompressionMetrics uncompressed, peak, rms;
+    streamingMetrics.getMetrics(uncompressed, peak, rms);
+
+    auto report = buildMetricsReport(uncompressed, peak, rms);
+    report << "\n" << pipeline.formatStatistics(cfg.pipelined ? "Pipelined streaming stages" : "Serial streaming stages");
+
+    if (!exporter.exportMetricsOnly(selectedFile, report, &err))
+        throw std::runtime_error(err.toStdString());
+}
+
 void MetricsExtractionEngine::compressAudioFile()
 {
     jassert(uncompressedSignal.getNumSamples() > 0);
@@ -101,10 +285,47 @@ void MetricsExtractionEngine::compressAudioFile()
     peakCompressedSignal.makeCopyOf(uncompressedSignal);
     rmsCompressedSignal.makeCopyOf(uncompressedSignal);
 
+    if (cfg.controlRateComparison > 1)
+    {
+        compressAtControlRate(peakControlRateGainReduction, false, peakCompressor);
+        compressAtControlRate(rmsControlRateGainReduction, true, rmsCompressor);
+    }
+
+    if (cfg.parallelCompression)
+    {
+        processBufferInSegments(peakGainReductionSignal, peakCompressedSignal, false, peakCompressor, peakParallelReport);
+        processBufferInSegments(rmsGainReductionSignal, rmsCompressedSignal, true, rmsCompressor, rmsParallelReport);
+        return;
+    }
+
+    peakParallelReport = {};
+    rmsParallelReport = {};
+
     processBufferInChunks(peakGainReductionSignal, peakCompressedSignal, false, peakCompressor);
     processBufferInChunks(rmsGainReductionSignal, rmsCompressedSignal, true, rmsCompressor);
 }
 
+void MetricsExtractionEngine::compressAtControlRate(juce::AudioBuffer<float>& controlRateGainReduction,
+    bool isRMS,
+    Compressor& compressor)
+{
+    const int numSamples = uncompressedSignal.getNumSamples();
+    const int numChannels = uncompressedSignal.getNumChannels();
+
+    // Independent copy, so the shared compressor keeps its own control rate
+    Compressor controlRateCompressor;
+    controlRateCompressor.copyParametersFrom(compressor);
+    controlRateCompressor.setProcessingMode(Compressor::ProcessingMode::Fused);
+    controlRateCompressor.setControlRate(cfg.controlRateComparison);
+    controlRateCompressor.prepareForMetricsExtraction({ fileSampleRate, static_cast<uint32_t>(cfg.chunkSize), static_cast<uint32_t>(numChannels) });
+
+    juce::AudioBuffer<float> chunkBuffer(numChannels, cfg.chunkSize);
+    controlRateGainReduction.setSize(numChannels, numSamples, false, true, true);
+
+    compressRange(controlRateCompressor, isRMS, uncompressedSignal, nullptr, &controlRateGainReduction, chunkBuffer,
+        0, numSamples, controlRateCompressor.getLatencySamples());
+}
+
 void MetricsExtractionEngine::processBufferInChunks(juce::AudioBuffer<float>& grBuffer,
     juce::AudioBuffer<float>& audioBuffer,
     bool isRMS,
@@ -116,42 +337,172 @@ void MetricsExtractionEngine::processBufferInChunks(juce::AudioBuffer<float>& gr
 
     // the compressor now operates on a loaded audio signal during offline analysis
     // so the compressor settings have to reflect loaded audio parameters
-    compressor.prepareForMetricsExtraction({ fileSampleRate, static_cast<uint32_t>(chunkSize), 2 });
+    compressor.prepareForMetricsExtraction({ fileSampleRate, static_cast<uint32_t>(chunkSize), static_cast<uint32_t>(numChannels) });
 
     juce::AudioBuffer<float> chunkBuffer;
     chunkBuffer.setSize(numChannels, chunkSize, false, true, true);
 
-    for (int start = 0; start < numSamples; start += chunkSize)
+    // compressor.process() isn't called directly because the compressor is bypassed
+    // during metrics extraction
+    // Output and gain reduction are aligned with the input, i.e. the lookahead latency is compensated
+    compressRange(compressor, isRMS, audioBuffer, &audioBuffer, &grBuffer, chunkBuffer, 0, numSamples, compressor.getLatencySamples());
+
+    // Back to real time processing compressor settings after the compression is finished
+    compressor.prepareForRealTimeProcessing();
+}
+
+void MetricsExtractionEngine::processBufferInSegments(juce::AudioBuffer<float>& grBuffer,
+    juce::AudioBuffer<float>& audioBuffer,
+    bool isRMS,
+    Compressor& compressor,
+    ParallelCompressionReport& report)
+{
+    const int numSamples = audioBuffer.getNumSamples();
+    const int numChannels = audioBuffer.getNumChannels();
+    const int chunkSize = cfg.chunkSize;
+
+    // Per-segment compressors start from the same settings as the shared compressor,
+    // the shared compressor itself is left untouched
+    const int warmUpSamples = getWarmUpSamples(compressor);
+    const int requestedSegments = cfg.numSegments > 0 ? cfg.numSegments : juce::SystemStats::getNumCpus();
+
+    // Segments shorter than the warm-up would spend most of their time re-processing old audio
+    const int maxSegments = juce::jmax(1, numSamples / juce::jmax(chunkSize, warmUpSamples));
+    const int numSegments = juce::jlimit(1, maxSegments, requestedSegments);
+    const int segmentLength = (numSamples + numSegments - 1) / numSegments;
+
+    report = {};
+    report.used = true;
+    report.numSegments = numSegments;
+    report.warmUpSamples = warmUpSamples;
+
+    juce::ThreadPool pool(numSegments);
+    juce::WaitableEvent allSegmentsDone;
+    std::atomic<int> segmentsLeft{ numSegments };
+
+    for (int segment = 0; segment < numSegments; ++segment)
     {
-        const int n = std::min(chunkSize, numSamples - start);
-        if (n <= 0) continue;
+        const int start = segment * segmentLength;
+        const int end = juce::jmin(numSamples, start + segmentLength);
+
+        pool.addJob([this, &compressor, &audioBuffer, &grBuffer, &allSegmentsDone, &segmentsLeft,
+                     isRMS, start, end, warmUpSamples, numChannels, chunkSize]()
+            {
+                Compressor segmentCompressor;
+                segmentCompressor.copyParametersFrom(compressor);
+                segmentCompressor.prepareForMetricsExtraction({ fileSampleRate, static_cast<uint32_t>(chunkSize), static_cast<uint32_t>(numChannels) });
+
+                juce::AudioBuffer<float> chunkBuffer(numChannels, chunkSize);
+
+                // Warm-up reads the uncompressed signal, other segments may already be writing
+                // their output to audioBuffer
+                const int warmUpStart = juce::jmax(0, start - warmUpSamples);
+                compressRange(segmentCompressor, isRMS, uncompressedSignal, nullptr, nullptr, chunkBuffer, warmUpStart, start, 0);
+                compressRange(segmentCompressor, isRMS, uncompressedSignal, &audioBuffer, &grBuffer, chunkBuffer,
+                    start, end, segmentCompressor.getLatencySamples());
+
+                if (--segmentsLeft == 0)
+                    allSegmentsDone.signal();
+            });
+    }
 
-        if (n < chunkSize) chunkBuffer.setSize(numChannels, n, false, true, true);
+    allSegmentsDone.wait();
+
+    if (cfg.verifyParallelCompression)
+    {
+        juce::AudioBuffer<float> serialSignal, serialGainReduction;
+        serialSignal.makeCopyOf(uncompressedSignal);
+        serialGainReduction.setSize(numChannels, numSamples, false, true, true);
+
+        processBufferInChunks(serialGainReduction, serialSignal, isRMS, compressor);
 
         for (int ch = 0; ch < numChannels; ++ch)
-            chunkBuffer.copyFrom(ch, 0, audioBuffer, ch, start, n);
+        {
+            const float* parallelOut = audioBuffer.getReadPointer(ch);
+            const float* serialOut = serialSignal.getReadPointer(ch);
+            const float* parallelGR = grBuffer.getReadPointer(ch);
+            const float* serialGR = serialGainReduction.getReadPointer(ch);
+
+            for (int n = 0; n < numSamples; ++n)
+            {
+                report.maxSignalDeviation = std::max(report.maxSignalDeviation, std::abs(parallelOut[n] - serialOut[n]));
+                report.maxGainReductionDeviation = std::max(report.maxGainReductionDeviation, std::abs(parallelGR[n] - serialGR[n]));
+            }
+        }
+        report.verified = true;
+    }
+}
 
-        // compressor.process() isn't called directly because the compressor is bypassed
-        // during metrics extraction
-        if (isRMS) compressor.applyRMSCompression(chunkBuffer, n, numChannels, true);
-        else       compressor.applyPeakCompression(chunkBuffer, n, numChannels, true);
+void MetricsExtractionEngine::compressRange(Compressor& compressor,
+    bool isRMS,
+    const juce::AudioBuffer<float>& source,
+    juce::AudioBuffer<float>* destination,
+    juce::AudioBuffer<float>* grDestination,
+    juce::AudioBuffer<float>& chunkBuffer,
+    int start,
+    int end,
+    int latency) const
+{
+    const int numChannels = source.getNumChannels();
+    const int sourceLength = source.getNumSamples();
+    const int chunkSize = chunkBuffer.getNumSamples();
+    const bool trackGR = grDestination != nullptr;
+
+    // With latency, output sample p comes out when input sample p + latency goes in,
+    // so the input runs latency samples further (zero padded past the end of the source)
+    for (int pos = start; pos < end + latency; pos += chunkSize)
+    {
+        const int n = std::min(chunkSize, end + latency - pos);
+        const int available = juce::jlimit(0, n, sourceLength - pos);
 
+        // Refer to the first n samples of the preallocated chunk buffer
+        juce::AudioBuffer<float> chunk(chunkBuffer.getArrayOfWritePointers(), numChannels, n);
 
-        auto& gr = compressor.getGainReductionSignal();
         for (int ch = 0; ch < numChannels; ++ch)
-            grBuffer.copyFrom(ch, start, gr, ch, 0, n);
+        {
+            chunk.copyFrom(ch, 0, source, ch, pos, available);
+            chunk.clear(ch, available, n - available);
+        }
 
-        for (int ch = 0; ch < numChannels; ++ch)
-            audioBuffer.copyFrom(ch, start, chunkBuffer, ch, 0, n);
+        if (isRMS) compressor.applyRMSCompression(chunk, n, numChannels, trackGR);
+        else       compressor.applyPeakCompression(chunk, n, numChannels, trackGR);
+
+        // Part of the chunk that belongs to the output range [start, end)
+        const int outputStart = juce::jmax(start, pos - latency);
+        const int outputEnd = juce::jmin(end, pos + n - latency);
+        if (outputEnd <= outputStart)
+            continue;
+
+        const int offset = outputStart - (pos - latency);
+        const int count = outputEnd - outputStart;
+
+        if (destination != nullptr)
+            for (int ch = 0; ch < numChannels; ++ch)
+                destination->copyFrom(ch, outputStart, chunk, ch, offset, count);
+
+        if (grDestination != nullptr)
+        {
+            const auto& gr = compressor.getGainReductionSignal();
+            for (int ch = 0; ch < numChannels; ++ch)
+                grDestination->copyFrom(ch, outputStart, gr, ch, offset, count);
+        }
     }
+}
 
-    // Back to real time processing compressor settings after the compression is finished
-    compressor.prepareForRealTimeProcessing();
+int MetricsExtractionEngine::getWarmUpSamples(Compressor& compressor) const
+{
+    // The detector is a one-pole recursion, after k time constants the influence of the
+    // initial state has decayed to e^-k
+    const double longestTimeConstant = std::max(compressor.getAttack(), compressor.getRelease()) * 0.001;
+    return static_cast<int>(std::ceil(cfg.warmUpTimeConstants * longestTimeConstant * fileSampleRate));
 }
 
 void MetricsExtractionEngine::getMetrics()
 {
     metrics.prepare(fileSampleRate);
+    metrics.setWindowing(cfg.windowSeconds, cfg.hopSeconds);
+    metrics.setNumThreads(cfg.metricsThreads);
+    metrics.setExactPercentiles(cfg.exactPercentiles);
 
     metrics.setUncompressedSignal(&uncompressedSignal);
     metrics.setPeakGainReductionSignal(&peakGainReductionSignal);
@@ -160,21 +511,59 @@ void MetricsExtractionEngine::getMetrics()
     metrics.setRMSCompressedSignal(&rmsCompressedSignal);
 
     metrics.extractMetrics();
+
+    peakControlRateReport = {};
+    rmsControlRateReport = {};
+
+    if (cfg.controlRateComparison > 1)
+    {
+        peakControlRateReport = compareControlRate(peakGainReductionSignal, peakControlRateGainReduction);
+        rmsControlRateReport = compareControlRate(rmsGainReductionSignal, rmsControlRateGainReduction);
+    }
 }
 
-juce::String MetricsExtractionEngine::buildMetricsReport() const
+MetricsExtractionEngine::ControlRateReport MetricsExtractionEngine::compareControlRate(
+    const juce::AudioBuffer<float>& fullRateGainReduction,
+    const juce::AudioBuffer<float>& controlRateGainReduction)
+{
+    ControlRateReport report;
+    report.used = true;
+    report.controlInterval = cfg.controlRateComparison;
+    report.fullRate = metrics.getGainReductionStatistics(fullRateGainReduction);
+    report.controlRate = metrics.getGainReductionStatistics(controlRateGainReduction);
+
+    // All channels carry the same (linked) gain reduction, the first one is enough
+    const int numSamples = fullRateGainReduction.getNumSamples();
+    const float* fullRate = fullRateGainReduction.getReadPointer(0);
+    const float* controlRate = controlRateGainReduction.getReadPointer(0);
+
+    double sumDeviation = 0.0;
+    for (int n = 0; n < numSamples; ++n)
+    {
+        const float deviation = std::abs(juce::Decibels::gainToDecibels(controlRate[n]) - juce::Decibels::gainToDecibels(fullRate[n]));
+        report.maxDeviationDb = std::max(report.maxDeviationDb, deviation);
+        sumDeviation += deviation;
+    }
+    report.meanDeviationDb = numSamples > 0 ? static_cast<float>(sumDeviation / numSamples) : 0.0f;
+
+    return report;
+}
+
+juce::String MetricsExtractionEngine::buildMetricsReport(const Metrics::CompressionMetrics& uncompressed,
+    const Metrics::CompressionMetrics& peak,
+    const Metrics::CompressionMetrics& rms) const
 {
     juce::String text;
     text << "Metrics Summary for: " << selectedFile.getFileName() << "\n\n";
 
-    const auto& uncompressed = metrics.getUncompressedMetrics();
-    const auto& peak = metrics.getPeakMetrics();
-    const auto& rms = metrics.getRMSMetrics();
-
     text << uncompressed.formatMetrics();
     text << formatParameterBlock("Compression parameter values for peak detection", "peak_");
+    text << formatParallelReport("Segment-parallel peak compression", peakParallelReport);
+    text << formatControlRateReport("Control-rate peak compression", peakControlRateReport);
     text << peak.formatMetrics();
     text << formatParameterBlock("Compression parameter values for rms detection", "rms_");
+    text << formatParallelReport("Segment-parallel rms compression", rmsParallelReport);
+    text << formatControlRateReport("Control-rate rms compression", rmsControlRateReport);
     text << rms.formatMetrics();
 
     return text;
@@ -190,13 +579,59 @@ juce::String MetricsExtractionEngine::formatParameterBlock(const juce::String& t
     c << "Knee: " << getParam(prefix + "knee") << ", ";
     c << "Attack: " << getParam(prefix + "attack") << ", ";
     c << "Release: " << getParam(prefix + "release") << ", ";
-    c << "Makeup Gain: " << getParam(prefix + "makeup") << ".\n";
+    c << "Makeup Gain: " << getParam(prefix + "makeup") << ", ";
+    c << "Lookahead: " << getParam("lookahead") << ".\n";
+    return c;
+}
+
+juce::String MetricsExtractionEngine::formatParallelReport(const juce::String& title,
+    const ParallelCompressionReport& report) const
+{
+    if (!report.used)
+        return {};
+
+    juce::String c;
+    c << title << ":\n";
+    c << "Segments: " << report.numSegments << ", ";
+    c << "Warm-up in ms: " << 1000.0 * report.warmUpSamples / fileSampleRate;
+
+    if (report.verified)
+    {
+        c << ", Max deviation from serial in dB: " << juce::Decibels::gainToDecibels(report.maxSignalDeviation, -200.0f);
+        c << ", Max GR deviation from serial in dB: " << juce::Decibels::gainToDecibels(report.maxGainReductionDeviation, -200.0f);
+    }
+
+    c << ".\n";
+    return c;
+}
+
+juce::String MetricsExtractionEngine::formatControlRateReport(const juce::String& title,
+    const ControlRateReport& report) const
+{
+    if (!report.used)
+        return {};
+
+    auto formatStatistics = [](const Metrics::GainReductionStatistics& st)
+    {
+        juce::String c;
+        c << "max GR " << st.maxGR << " dB, ";
+        c << "avg GR " << st.avgGR << " dB, ";
+        c << "GR energy " << st.energyGR << " dB, ";
+        c << "std dev " << st.stdDevGR << ", ";
+        c << "rate of change " << st.rateOfChangeGR << ", ";
+        c << "activity " << st.compressionActivityRatio;
+        return c;
+    };
+
+    juce::String c;
+    c << title << " (gain every " << report.controlInterval << " samples):\n";
+    c << "Full rate: " << formatStatistics(report.fullRate) << "\n";
+    c << "Control rate: " << formatStatistics(report.controlRate) << "\n";
+    c << "GR deviation from full rate in dB: max " << report.maxDeviationDb << ", mean " << report.meanDeviationDb << ".\n";
     return c;
 }
 
 float MetricsExtractionEngine::getParam(const juce::String& id) const
 {
-    if (auto* v = apvts.getRawParameterValue(id))
-        return v->load();
-    return 0.0f;
+    return parameterSource ? parameterSource(id) : 0.0f;
 }
@@ -0,0 +1,105 @@
+/*
+ * This file implements QuantileHistogram, see QuantileHistogram.h.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/QuantileHistogram.h"
+#include "../dsp/include/FastMath.h"
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+QuantileHistogram::QuantileHistogram(float min, float max, int newNumBins)
+    : minValue(min),
+      maxValue(max),
+      numBins(juce::jmax(3, newNumBins)),
+      binsPerOctave(static_cast<float>(numBins - 2) / std::log2(max / min)),
+      bins(static_cast<size_t>(numBins), 0)
+{
+    jassert(min > 0.0f && max > min);
+}
+
+QuantileHistogram QuantileHistogram::forSampleDeltas()
+{
+    return QuantileHistogram(1.0e-6f, 4.0f, 4096);
+}
+
+QuantileHistogram QuantileHistogram::forWindowEnergies()
+{
+    return QuantileHistogram(1.0e-5f, 16.0f, 4096);
+}
+
+//==============================================================================
+void QuantileHistogram::reset()
+{
+    std::fill(bins.begin(), bins.end(), 0);
+    count = 0;
+}
+
+void QuantileHistogram::add(float value)
+{
+    int bin = 0;
+    if (value >= maxValue)
+        bin = numBins - 1;
+    else if (value >= minValue)
+        bin = 1 + static_cast<int>(FastMath::log2Approx(value / minValue) * binsPerOctave);
+
+    ++bins[static_cast<size_t>(juce::jlimit(0, numBins - 1, bin))];
+    ++count;
+}
+
+void QuantileHistogram::add(const float* values, int numValues)
+{
+    for (int i = 0; i < numValues; ++i)
+        add(values[i]);
+}
+
+void QuantileHistogram::merge(const QuantileHistogram& other)
+{
+    jassert(other.numBins == numBins && other.minValue == minValue && other.maxValue == maxValue);
+
+    for (size_t bin = 0; bin < bins.size(); ++bin)
+        bins[bin] += other.bins[bin];
+    count += other.count;
+}
+
+//==============================================================================
+float QuantileHistogram::getValueAtRank(juce::uint64 rank) const
+{
+    juce::uint64 seen = 0;
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        seen += bins[static_cast<size_t>(bin)];
+        if (seen > rank)
+        {
+            if (bin == 0)
+                return 0.0f;
+            if (bin == numBins - 1)
+                return maxValue;
+
+            // Geometric center of the bin
+            return minValue * std::exp2((static_cast<float>(bin - 1) + 0.5f) / binsPerOctave);
+        }
+    }
+    return maxValue;
+}
+
+float QuantileHistogram::getMaxRelativeError() const
+{
+    return std::exp2(0.5f / binsPerOctave) - 1.0f;
+}
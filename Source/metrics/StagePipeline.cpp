@@ -0,0 +1,214 @@
+/*
+ * This file implements StagePipeline, see StagePipeline.h.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/StagePipeline.h"
+
+StagePipeline::StagePipeline(int slots)
+    : numSlots(juce::jmax(1, slots))
+{
+}
+
+int StagePipeline::addStage(const juce::String& name, StageFunction function, std::vector<int> dependencies)
+{
+    for (const int dependency : dependencies)
+        jassert(dependency >= 0 && dependency < static_cast<int>(stages.size()));
+
+    auto stage = std::make_unique<Stage>();
+    stage->name = name;
+    stage->function = std::move(function);
+    stage->dependencies = std::move(dependencies);
+    stages.push_back(std::move(stage));
+
+    return static_cast<int>(stages.size()) - 1;
+}
+
+//==============================================================================
+bool StagePipeline::run(juce::int64 numChunks, juce::String* error)
+{
+    resetStatistics();
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    const int numStages = static_cast<int>(stages.size());
+    juce::ThreadPool pool(numStages);
+    juce::WaitableEvent allStagesDone;
+    std::atomic<int> stagesLeft{ numStages };
+
+    for (int s = 0; s < numStages; ++s)
+    {
+        pool.addJob([this, s, numChunks, &allStagesDone, &stagesLeft]()
+            {
+                runStage(s, numChunks);
+
+                if (--stagesLeft == 0)
+                    allStagesDone.signal();
+            });
+    }
+
+    allStagesDone.wait();
+    finishStatistics(startTicks);
+
+    if (failed.load() && error != nullptr)
+        *error = failure;
+
+    return !failed.load();
+}
+
+bool StagePipeline::runSerially(juce::int64 numChunks, juce::String* error)
+{
+    resetStatistics();
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    juce::String message;
+
+    for (juce::int64 chunk = 0; chunk < numChunks && !failed.load(); ++chunk)
+    {
+        for (size_t s = 0; s < stages.size(); ++s)
+        {
+            const auto begin = juce::Time::getHighResolutionTicks();
+            const bool ok = stages[s]->function(static_cast<int>(chunk % numSlots), chunk, message);
+            statistics[s].busySeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - begin);
+
+            if (!ok)
+            {
+                fail(message);
+                break;
+            }
+
+            ++statistics[s].numChunks;
+        }
+    }
+
+    finishStatistics(startTicks);
+
+    if (failed.load() && error != nullptr)
+        *error = failure;
+
+    return !failed.load();
+}
+
+//==============================================================================
+bool StagePipeline::isReady(const Stage& stage, juce::int64 chunkIndex) const
+{
+    // Source stage: the slot is free once every stage is done with the chunk numSlots earlier
+    if (stage.dependencies.empty())
+    {
+        for (const auto& other : stages)
+            if (other->finished.load(std::memory_order_acquire) <= chunkIndex - numSlots)
+                return false;
+        return true;
+    }
+
+    for (const int dependency : stage.dependencies)
+        if (stages[static_cast<size_t>(dependency)]->finished.load(std::memory_order_acquire) <= chunkIndex)
+            return false;
+
+    return true;
+}
+
+void StagePipeline::runStage(int stageIndex, juce::int64 numChunks)
+{
+    auto& stage = *stages[static_cast<size_t>(stageIndex)];
+    auto& stats = statistics[static_cast<size_t>(stageIndex)];
+    juce::String message;
+
+    for (juce::int64 chunk = 0; chunk < numChunks; ++chunk)
+    {
+        // Wait for the input (or a free slot)
+        const auto waitBegin = juce::Time::getHighResolutionTicks();
+        while (!isReady(stage, chunk) && !failed.load())
+            stage.progressed.wait(1);
+        const auto begin = juce::Time::getHighResolutionTicks();
+        stats.waitingSeconds += juce::Time::highResolutionTicksToSeconds(begin - waitBegin);
+
+        if (failed.load())
+            return;
+
+        const bool ok = stage.function(static_cast<int>(chunk % numSlots), chunk, message);
+        stats.busySeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - begin);
+
+        if (!ok)
+        {
+            fail(message);
+            return;
+        }
+
+        ++stats.numChunks;
+        stage.finished.store(chunk + 1, std::memory_order_release);
+        wakeAll();
+    }
+}
+
+void StagePipeline::fail(const juce::String& message)
+{
+    {
+        const juce::ScopedLock lock(errorLock);
+        if (!failed.load())
+            failure = message;
+        failed = true;
+    }
+
+    wakeAll();
+}
+
+void StagePipeline::wakeAll()
+{
+    for (auto& stage : stages)
+        stage->progressed.signal();
+}
+
+//==============================================================================
+void StagePipeline::resetStatistics()
+{
+    failed = false;
+    failure.clear();
+    wallSeconds = 0.0;
+
+    statistics.assign(stages.size(), {});
+    for (size_t s = 0; s < stages.size(); ++s)
+    {
+        statistics[s].name = stages[s]->name;
+        stages[s]->finished = 0;
+        stages[s]->progressed.reset();
+    }
+}
+
+void StagePipeline::finishStatistics(juce::int64 startTicks)
+{
+    wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+    for (auto& stats : statistics)
+        stats.utilization = wallSeconds > 0.0 ? stats.busySeconds / wallSeconds : 0.0;
+}
+
+juce::String StagePipeline::formatStatistics(const juce::String& title) const
+{
+    juce::String c;
+    c << title << " (" << numSlots << " slots, wall time " << juce::String(wallSeconds, 3) << " s):\n";
+
+    for (const auto& stats : statistics)
+    {
+        c << stats.name << ": chunks " << stats.numChunks
+          << ", busy " << juce::String(stats.busySeconds, 3) << " s"
+          << ", waiting " << juce::String(stats.waitingSeconds, 3) << " s"
+          << ", utilization " << juce::String(100.0 * stats.utilization, 1) << "%.\n";
+    }
+
+    return c;
+}
@@ -0,0 +1,256 @@
+/*
+ * This file implements StreamingMetrics, see StreamingMetrics.h.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/StreamingMetrics.h"
+#include "include/DerivedSignal.h"
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+void StreamingMetrics::setWindowing(float windowSeconds, float hopSeconds)
+{
+    jassert(windowSeconds > 0.0f && hopSeconds > 0.0f);
+    windowDuration = windowSeconds;
+    hopDuration = hopSeconds;
+}
+
+void StreamingMetrics::prepare(double fs, int channels)
+{
+    sampleRate = fs;
+    numChannels = channels;
+    numFrames = 0;
+
+    const int windowSize = static_cast<int>(windowDuration * sampleRate);
+    const int hopSize = static_cast<int>(hopDuration * sampleRate);
+
+    for (auto* signal : { &uncompressedSignal, &peakSignal, &rmsSignal })
+        signal->prepare(sampleRate, numChannels, windowSize, hopSize);
+
+    for (auto* totals : { &uncompressedTotals, &peakTotals, &rmsTotals })
+        totals->prepare(numChannels);
+}
+
+void StreamingMetrics::process(const juce::AudioBuffer<float>& uncompressed,
+    const juce::AudioBuffer<float>& peak, const juce::AudioBuffer<float>& peakGR,
+    const juce::AudioBuffer<float>& rms, const juce::AudioBuffer<float>& rmsGR,
+    int startSample, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    uncompressedSignal.process(uncompressed, startSample, numSamples);
+    peakSignal.process(peak, startSample, numSamples);
+    rmsSignal.process(rms, startSample, numSamples);
+
+    uncompressedTotals.process(&uncompressed, nullptr, nullptr, startSample, numSamples);
+    peakTotals.process(&peak, &uncompressed, &peakGR, startSample, numSamples);
+    rmsTotals.process(&rms, &uncompressed, &rmsGR, startSample, numSamples);
+
+    numFrames += numSamples;
+}
+
+void StreamingMetrics::getMetrics(Metrics::CompressionMetrics& uncompressed,
+    Metrics::CompressionMetrics& peak,
+    Metrics::CompressionMetrics& rms) const
+{
+    uncompressed = {};
+    uncompressed.signalName = "Uncompressed signal";
+    fillSignalMetrics(uncompressedSignal, uncompressedTotals, uncompressed);
+
+    peak = {};
+    peak.signalName = "Peak compressed signal";
+    peak.isCompressed = true;
+    fillSignalMetrics(peakSignal, peakTotals, peak);
+    fillCompressionMetrics(peakSignal, peakTotals, peak);
+    peak.dynamicRangeReductionCrest = uncompressed.crestFactor - peak.crestFactor;
+    peak.dynamicRangeReductionLRA = uncompressed.lra - peak.lra;
+
+    rms = {};
+    rms.signalName = "RMS compressed signal";
+    rms.isCompressed = true;
+    fillSignalMetrics(rmsSignal, rmsTotals, rms);
+    fillCompressionMetrics(rmsSignal, rmsTotals, rms);
+    rms.dynamicRangeReductionCrest = uncompressed.crestFactor - rms.crestFactor;
+    rms.dynamicRangeReductionLRA = uncompressed.lra - rms.lra;
+}
+
+// Metrics of the accumulated statistics
+//==============================================================================
+void StreamingMetrics::fillSignalMetrics(const SignalAccumulator& signal, const MetricsAccumulator& totals,
+    Metrics::CompressionMetrics& metrics) const
+{
+    const double total = static_cast<double>(numFrames) * numChannels;
+    if (total <= 0.0)
+        return;
+
+    metrics.meanEnergy = totals.getMeanEnergy();
+    metrics.peak = totals.getPeak();
+    metrics.rms = std::sqrt(metrics.meanEnergy);
+    metrics.crestFactor = juce::Decibels::gainToDecibels(metrics.peak / metrics.rms);
+    metrics.lufs = juce::Decibels::gainToDecibels(static_cast<float>(signal.kWeightedWindows.getTotalEnergy() / total)) - 0.691f;
+    metrics.lra = getLRA(signal.kWeightedWindows.getWindowEnergies());
+}
+
+void StreamingMetrics::fillCompressionMetrics(const SignalAccumulator& signal, const MetricsAccumulator& totals,
+    Metrics::CompressionMetrics& metrics) const
+{
+    const double total = static_cast<double>(numFrames) * numChannels;
+    if (total <= 0.0)
+        return;
+
+    // Transient impact, from the same percentile of the sample deltas of both signals
+    const auto& uncompressedDeltas = uncompressedSignal.deltas;
+    const auto& compressedDeltas = signal.deltas;
+
+    if (uncompressedDeltas.getCount() > 0 && compressedDeltas.getCount() > 0)
+    {
+        const auto rank = [](const QuantileHistogram& h)
+            {
+                return static_cast<juce::uint64>(std::floor(transientPercentile * static_cast<double>(h.getCount() - 1)));
+            };
+
+        const float uncompressedStrength = uncompressedDeltas.getValueAtRank(rank(uncompressedDeltas));
+        const float compressedStrength = compressedDeltas.getValueAtRank(rank(compressedDeltas));
+
+        if (uncompressedStrength > 1.0e-12f)
+            metrics.transientImpact = juce::jlimit(-1.0f, 1.0f, 1.0f - compressedStrength / uncompressedStrength);
+    }
+
+    metrics.transientEnergyPreservation = getTransientEnergyPreservation(
+        uncompressedSignal.windows.getWindowEnergies(), signal.windows.getWindowEnergies());
+
+    metrics.harmonicDistortion = totals.getWaveformDistortion();
+
+    const auto grStatistics = totals.getGainReductionStatistics(sampleRate);
+    metrics.avgGR = grStatistics.avgGR;
+    metrics.maxGR = grStatistics.maxGR;
+    metrics.stdDevGR = grStatistics.stdDevGR;
+    metrics.energyGR = grStatistics.energyGR;
+    metrics.rateOfChangeGR = grStatistics.rateOfChangeGR;
+    metrics.compressionActivityRatio = grStatistics.compressionActivityRatio;
+}
+
+float StreamingMetrics::getLRA(const std::vector<float>& windowEnergies)
+{
+    if (windowEnergies.empty())
+        return 0.0f;
+
+    // Same ranks as Metrics::getLRA, the -0.691 dB of both percentiles cancel out
+    QuantileHistogram energies = QuantileHistogram::forWindowEnergies();
+    energies.add(windowEnergies.data(), static_cast<int>(windowEnergies.size()));
+
+    const juce::uint64 n = energies.getCount();
+    return juce::Decibels::gainToDecibels(energies.getValueAtRank(static_cast<juce::uint64>(0.95 * n)))
+        - juce::Decibels::gainToDecibels(energies.getValueAtRank(static_cast<juce::uint64>(0.1 * n)));
+}
+
+float StreamingMetrics::getTransientEnergyPreservation(const std::vector<float>& uncompressedEnergies,
+    const std::vector<float>& compressedEnergies)
+{
+    if (uncompressedEnergies.empty() || uncompressedEnergies.size() != compressedEnergies.size())
+        return 0.0f;
+
+    std::vector<float> uncompressedRMS(uncompressedEnergies.size());
+    std::transform(uncompressedEnergies.begin(), uncompressedEnergies.end(), uncompressedRMS.begin(),
+        [](float energy) { return std::sqrt(energy); });
+
+    float sumUncompressedRMS = 0.0f;
+    for (const float rmsU : uncompressedRMS)
+        sumUncompressedRMS += rmsU;
+
+    if (sumUncompressedRMS <= 0.0f)
+        return 0.0f;
+
+    auto sorted = uncompressedRMS;
+    const size_t thresholdIndex = static_cast<size_t>(transientPercentile * (sorted.size() - 1));
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<ptrdiff_t>(thresholdIndex), sorted.end());
+    const float threshold = sorted[thresholdIndex];
+
+    // Energy in the transient windows before and after compression
+    float uncompressedEnergy = 0.0f;
+    float compressedEnergy = 0.0f;
+
+    for (size_t k = 0; k < uncompressedRMS.size(); ++k)
+    {
+        if (uncompressedRMS[k] > threshold)
+        {
+            uncompressedEnergy += uncompressedEnergies[k];
+            compressedEnergy += compressedEnergies[k];
+        }
+    }
+
+    if (uncompressedEnergy <= 0.0f)
+        return 0.0f;
+
+    return std::min(1.0f, compressedEnergy / uncompressedEnergy);
+}
+
+// SignalAccumulator
+//==============================================================================
+void StreamingMetrics::SignalAccumulator::prepare(double fs, int channels, int windowSize, int hopSize)
+{
+    numChannels = channels;
+
+    // Same K-weighting filters as Metrics, one state per channel
+    lowShelf.clear();
+    highShelf.clear();
+    lowShelf.resize(static_cast<size_t>(numChannels));
+    highShelf.resize(static_cast<size_t>(numChannels));
+    for (size_t ch = 0; ch < lowShelf.size(); ++ch)
+        DerivedSignal::prepareKWeighting(lowShelf[ch], highShelf[ch], fs);
+
+    previousSample.assign(static_cast<size_t>(numChannels), 0.0f);
+    hasPreviousSample = false;
+
+    windows.prepare(windowSize, hopSize, numChannels);
+    kWeightedWindows.prepare(windowSize, hopSize, numChannels);
+    deltas.reset();
+}
+
+void StreamingMetrics::SignalAccumulator::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    kWeighted.setSize(numChannels, numSamples, false, false, true);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* x = buffer.getReadPointer(ch, startSample);
+        float* weighted = kWeighted.getWritePointer(ch);
+        auto& low = lowShelf[static_cast<size_t>(ch)];
+        auto& high = highShelf[static_cast<size_t>(ch)];
+        float previous = previousSample[static_cast<size_t>(ch)];
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            const float sample = x[n];
+            weighted[n] = high.processSample(low.processSample(sample));
+
+            if (n > 0 || hasPreviousSample)
+                deltas.add(std::abs(sample - previous));
+            previous = sample;
+        }
+
+        previousSample[static_cast<size_t>(ch)] = previous;
+    }
+
+    hasPreviousSample = true;
+
+    windows.process(buffer, startSample, numSamples);
+    kWeightedWindows.process(kWeighted, 0, numSamples);
+}
@@ -0,0 +1,136 @@
+/*
+ * This file implements TaskGraph, see TaskGraph.h.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/TaskGraph.h"
+#include <algorithm>
+
+void TaskGraph::clear()
+{
+    tasks.clear();
+    timings.clear();
+    wallSeconds = 0.0;
+    usedThreads = 0;
+}
+
+int TaskGraph::addTask(const juce::String& name, TaskFunction function, std::vector<int> dependencies)
+{
+    const int index = static_cast<int>(tasks.size());
+
+    auto task = std::make_unique<Task>();
+    task->name = name;
+    task->function = std::move(function);
+    task->numDependencies = static_cast<int>(dependencies.size());
+
+    for (const int dependency : dependencies)
+    {
+        jassert(dependency >= 0 && dependency < index);
+        tasks[static_cast<size_t>(dependency)]->dependents.push_back(index);
+    }
+
+    tasks.push_back(std::move(task));
+    return index;
+}
+
+//==============================================================================
+void TaskGraph::run(int numThreads)
+{
+    const int numTasks = static_cast<int>(tasks.size());
+
+    timings.assign(tasks.size(), {});
+    for (size_t t = 0; t < tasks.size(); ++t)
+        timings[t].name = tasks[t]->name;
+
+    if (numThreads <= 0)
+        numThreads = juce::SystemStats::getNumCpus();
+    usedThreads = juce::jlimit(1, juce::jmax(1, numTasks), numThreads);
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    if (usedThreads == 1)
+    {
+        // Insertion order respects the dependencies
+        for (int t = 0; t < numTasks; ++t)
+            runTask(t, startTicks);
+    }
+    else if (numTasks > 0)
+    {
+        juce::ThreadPool threadPool(usedThreads);
+        pool = &threadPool;
+        allTasksDone.reset();
+        tasksLeft = numTasks;
+
+        for (auto& task : tasks)
+            task->waitingFor = task->numDependencies;
+
+        for (int t = 0; t < numTasks; ++t)
+            if (tasks[static_cast<size_t>(t)]->numDependencies == 0)
+                threadPool.addJob([this, t, startTicks]() { runTask(t, startTicks); enqueueReadyDependents(t, startTicks); });
+
+        allTasksDone.wait();
+        pool = nullptr;
+    }
+
+    wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+}
+
+void TaskGraph::runTask(int index, juce::int64 startTicks)
+{
+    const auto begin = juce::Time::getHighResolutionTicks();
+    tasks[static_cast<size_t>(index)]->function();
+    const auto end = juce::Time::getHighResolutionTicks();
+
+    // Every task writes only its own entry
+    auto& timing = timings[static_cast<size_t>(index)];
+    timing.startSeconds = juce::Time::highResolutionTicksToSeconds(begin - startTicks);
+    timing.busySeconds = juce::Time::highResolutionTicksToSeconds(end - begin);
+}
+
+void TaskGraph::enqueueReadyDependents(int index, juce::int64 startTicks)
+{
+    for (const int dependent : tasks[static_cast<size_t>(index)]->dependents)
+    {
+        // The task finishing the last dependency queues the dependent
+        if (--tasks[static_cast<size_t>(dependent)]->waitingFor == 0)
+            pool->addJob([this, dependent, startTicks]() { runTask(dependent, startTicks); enqueueReadyDependents(dependent, startTicks); });
+    }
+
+    if (--tasksLeft == 0)
+        allTasksDone.signal();
+}
+
+//==============================================================================
+juce::String TaskGraph::formatTimings(const juce::String& title) const
+{
+    double busySeconds = 0.0;
+    for (const auto& timing : timings)
+        busySeconds += timing.busySeconds;
+
+    juce::String c;
+    c << title << " (" << usedThreads << " threads, wall time " << juce::String(wallSeconds, 3) << " s"
+      << ", task time " << juce::String(busySeconds, 3) << " s):\n";
+
+    for (const auto& timing : timings)
+    {
+        c << timing.name << ": start " << juce::String(timing.startSeconds, 3) << " s"
+          << ", busy " << juce::String(timing.busySeconds, 3) << " s.\n";
+    }
+
+    return c;
+}
@@ -0,0 +1,114 @@
+/*
+ * This file implements WindowedEnergy, see WindowedEnergy.h.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/WindowedEnergy.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+    // Silence gated energy of n samples, over 8 lanes so the loop vectorizes
+    double gatedEnergy(const float* x, int n, float threshold)
+    {
+        constexpr int numLanes = 8;
+        float lanes[numLanes] = {};
+
+        int i = 0;
+        for (; i + numLanes <= n; i += numLanes)
+            for (int l = 0; l < numLanes; ++l)
+                lanes[l] += std::abs(x[i + l]) >= threshold ? x[i + l] * x[i + l] : 0.0f;
+        for (; i < n; ++i)
+            lanes[0] += std::abs(x[i]) >= threshold ? x[i] * x[i] : 0.0f;
+
+        double sum = 0.0;
+        for (const float lane : lanes)
+            sum += lane;
+        return sum;
+    }
+}
+
+//==============================================================================
+void WindowedEnergy::prepare(int newWindowSize, int newHopSize, int channels)
+{
+    windowSize = newWindowSize;
+    hopSize = newHopSize;
+    numChannels = channels;
+
+    blockSize = windowSize > 0 && hopSize > 0 ? std::gcd(windowSize, hopSize) : 0;
+    blocksPerWindow = blockSize > 0 ? windowSize / blockSize : 0;
+    blocksPerHop = blockSize > 0 ? hopSize / blockSize : 0;
+
+    samplesInBlock = 0;
+    blockEnergy = 0.0;
+    numBlocks = 0;
+    recentBlocks.assign(static_cast<size_t>(blocksPerWindow), 0.0);
+    windowSum = 0.0;
+    totalEnergy = 0.0;
+    windowEnergies.clear();
+}
+
+void WindowedEnergy::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    if (blockSize <= 0)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            totalEnergy += gatedEnergy(buffer.getReadPointer(ch, startSample), numSamples, silenceThreshold);
+        return;
+    }
+
+    // Fill the current block channel by channel, then move on to the next one
+    while (numSamples > 0)
+    {
+        const int n = std::min(numSamples, blockSize - samplesInBlock);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            blockEnergy += gatedEnergy(buffer.getReadPointer(ch, startSample), n, silenceThreshold);
+
+        samplesInBlock += n;
+        startSample += n;
+        numSamples -= n;
+
+        if (samplesInBlock == blockSize)
+            finishBlock();
+    }
+}
+
+void WindowedEnergy::finishBlock()
+{
+    const size_t slot = static_cast<size_t>(numBlocks % blocksPerWindow);
+
+    windowSum += blockEnergy - recentBlocks[slot];
+    recentBlocks[slot] = blockEnergy;
+    totalEnergy += blockEnergy;
+    ++numBlocks;
+
+    blockEnergy = 0.0;
+    samplesInBlock = 0;
+
+    // Resum once per round so the running sum doesn't drift
+    if (slot + 1 == recentBlocks.size())
+        windowSum = std::accumulate(recentBlocks.begin(), recentBlocks.end(), 0.0);
+
+    // Window k covers the blocks [k * blocksPerHop, k * blocksPerHop + blocksPerWindow)
+    const juce::int64 firstBlock = numBlocks - blocksPerWindow;
+    if (firstBlock >= 0 && firstBlock % blocksPerHop == 0)
+        windowEnergies.push_back(static_cast<float>(std::max(0.0, windowSum) / (static_cast<double>(windowSize) * numChannels)));
+}
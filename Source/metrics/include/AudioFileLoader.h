@@ -1,5 +1,6 @@
 #pragma once
 #include <JuceHeader.h>
+#include "DecodedAudioCache.h"
 
 class AudioFileLoader
 {
@@ -12,13 +13,33 @@ public:
 
     explicit AudioFileLoader(juce::AudioFormatManager& fm) : formatManager(fm) {}
 
+#if JUCE_MODULE_AVAILABLE_juce_gui_basics
     // UI: choose file (call on message thread)
     static juce::File chooseAudioFile();
+#endif
 
     // I/O: load file (can be called on background thread)
-    std::optional<LoadedAudio> loadAudioFile(const juce::File& file, juce::String* error = nullptr) const;
+    // maxDurationSeconds: files longer than this are rejected (0 => no limit)
+    std::optional<LoadedAudio> loadAudioFile(const juce::File& file, juce::String* error = nullptr,
+        double maxDurationSeconds = 0.0) const;
+
+    // I/O: open a mono or stereo file for chunk by chunk reading (streaming mode)
+    // Uncompressed WAV and AIFF files are memory mapped: reading a chunk converts it straight from
+    // the mapped file (page cache), without read calls or a decode of the whole file
+    std::unique_ptr<juce::AudioFormatReader> createReader(const juce::File& file, juce::String* error = nullptr) const;
+
+    // Memory mapping is on by default, turn it off e.g. for files on network drives
+    void setUseMemoryMapping(bool shouldUseMemoryMapping) { useMemoryMapping = shouldUseMemoryMapping; }
+
+    // Files that can't be memory mapped (e.g. MP3) are decoded into the cache once and read from
+    // there afterwards; nullptr (default) disables caching. The cache has to outlive the loader.
+    void setDecodedAudioCache(DecodedAudioCache* cache) { decodedAudioCache = cache; }
 
 private:
+    std::unique_ptr<juce::AudioFormatReader> createMemoryMappedReader(const juce::File& file) const;
+
     juce::AudioFormatManager& formatManager;
+    bool useMemoryMapping = true;
+    DecodedAudioCache* decodedAudioCache = nullptr;
 };
 
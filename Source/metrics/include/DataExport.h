@@ -31,6 +31,20 @@ public:
         const juce::String& metricsText,
         juce::String* error = nullptr);
 
+    // Streaming export: opens <input>_<suffix>.wav for chunk by chunk writing. Returns nullptr
+    // if WAV export is disabled or failed (error is only set on failure).
+    std::unique_ptr<juce::AudioFormatWriter> createWavWriter(const juce::File& inputFile,
+        const juce::String& suffix,
+        double sampleRate,
+        int numChannels,
+        juce::String* error = nullptr);
+
+    bool isExportingWavs() const { return cfg.exportWavs; }
+
+    // Writes a processBlock timing report (BlockProfiler::Statistics::format()).
+    bool exportProfile(const juce::String& profileText,
+        juce::String* error = nullptr);
+
     juce::File getOutputFolder() const { return outputFolder; }
 
 private:
@@ -38,8 +52,16 @@ private:
     juce::File makeUniqueFile(const juce::File& inputFile,
         const juce::String& suffix,
         const juce::String& extension) const;
+    juce::File makeUniqueFile(const juce::String& baseName,
+        const juce::String& suffix,
+        const juce::String& extension) const;
 
     bool saveText(const juce::File& file, const juce::String& content, juce::String* error) const;
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(const juce::File& file,
+        double sampleRate,
+        int numChannels,
+        int bitDepth,
+        juce::String* error) const;
     bool saveWav(const juce::File& file,
         const juce::AudioBuffer<float>& buffer,
         double sampleRate,
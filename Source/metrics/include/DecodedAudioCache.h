@@ -0,0 +1,82 @@
+/*
+ * This file defines DecodedAudioCache, an on-disk cache of decoded audio files.
+ *
+ * Key Features:
+ * - Entries are keyed by a 64-bit hash of the file contents plus the file size and sample rate,
+ *   so renamed or copied files hit the same entry and edited files never hit a stale one.
+ * - One file per entry: a 32 byte header followed by the samples as planar 32-bit floats, one
+ *   channel after the other. Entries are memory mapped for reading, a chunk read is a memcpy.
+ * - LRU size cap: hits refresh the modification time of an entry, and after every new entry the
+ *   least recently used ones are deleted until the cache fits into maxBytes.
+ * - New entries are decoded chunk by chunk into a temporary file and renamed when complete, so
+ *   an interrupted decode never leaves a broken entry behind.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+
+class DecodedAudioCache
+{
+public:
+    struct Config
+    {
+        juce::File directory;
+        juce::int64 maxBytes = juce::int64(4) << 30;   // 4 GB
+    };
+
+    explicit DecodedAudioCache(Config cfg);
+
+    // Key of a file decoded at sampleRate; reads (hashes) the whole file
+    static juce::String makeKey(const juce::File& file, double sampleRate);
+
+    // Reader of the cached entry, or nullptr if there is none
+    std::unique_ptr<juce::AudioFormatReader> createReader(const juce::String& key) const;
+
+    // Decodes source into a new entry and returns its reader (nullptr and error on failure)
+    std::unique_ptr<juce::AudioFormatReader> store(const juce::String& key,
+        juce::AudioFormatReader& source,
+        juce::String* error = nullptr);
+
+    const Config& getConfig() const { return cfg; }
+
+private:
+    class CachedReader;
+
+    // Layout of the entry header, followed by the planar float samples
+    struct Header
+    {
+        char magic[4];
+        juce::uint32 version;
+        juce::uint32 numChannels;
+        juce::uint32 reserved;
+        double sampleRate;
+        juce::int64 numSamples;
+    };
+    static_assert(sizeof(Header) == 32, "Samples have to start 32 byte aligned");
+
+    static constexpr juce::uint32 currentVersion = 1;
+    static constexpr int decodeChunkSize = 65536;
+
+    juce::File getEntryFile(const juce::String& key) const;
+    void enforceSizeLimit(const juce::File& keep) const;
+
+    Config cfg;
+};
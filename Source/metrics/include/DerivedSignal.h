@@ -0,0 +1,93 @@
+/*
+ * This file defines DerivedSignal, the cache of the data Metrics derives from one signal.
+ *
+ * Key Features:
+ * - Holds what the loudness and transient metrics need: the K-weighted energy, the window
+ *   energies of the signal and of its K-weighted version, and the sample delta percentile.
+ * - Everything is computed on first use and kept until reset(), so LUFS and LRA share one
+ *   K-weighting pass, and the uncompressed reference is analyzed once for both comparisons.
+ * - The K-weighted signal is produced chunk by chunk into a small scratch buffer and never
+ *   stored; each channel has its own filter state.
+ * - The sample deltas are counted in a QuantileHistogram (fixed memory) unless exact percentiles
+ *   are requested, which need a vector of all numChannels * (numSamples - 1) deltas.
+ * - Not thread safe: the first call of a getter has to happen before concurrent readers use it.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "QuantileHistogram.h"
+#include <vector>
+
+class DerivedSignal
+{
+public:
+    //==============================================================================
+    // Drops everything derived so far; windowSize and hopSize are in samples
+    void reset(const juce::AudioBuffer<float>* signal, double sampleRate, int windowSize, int hopSize);
+
+    // Exact percentiles (sorting all values) instead of histogram estimates; kept across reset()
+    void setExactPercentiles(bool shouldBeExact);
+
+    //==============================================================================
+    // Silence gated mean energy of the K-weighted signal (LUFS)
+    float getKWeightedMeanEnergy();
+
+    // Mean energy of every window of the K-weighted signal (LRA)
+    const std::vector<float>& getKWeightedWindowEnergies();
+
+    // RMS of every window of the signal (transient energy preservation)
+    const std::vector<float>& getWindowRMS();
+
+    // |x[n] - x[n-1]| over all channels at the given percentile (0..1), in linear gain (transient impact),
+    // relative error < 0.19% unless exact percentiles are set
+    float getDeltaPercentile(float percentile);
+
+    //==============================================================================
+    // The K-weighting filters of ITU-R BS.1770 as used by all loudness metrics
+    static void prepareKWeighting(juce::dsp::IIR::Filter<float>& lowShelf,
+        juce::dsp::IIR::Filter<float>& highShelf,
+        double sampleRate);
+
+private:
+    //==============================================================================
+    void computeWindows();
+    void computeDeltaHistogram();
+    float getExactDeltaPercentile(float percentile) const;
+
+    static constexpr int chunkSize = 8192;
+
+    const juce::AudioBuffer<float>* signal = nullptr;
+    double sampleRate{ 0.0 };
+    int windowSize{ 0 }, hopSize{ 0 };
+
+    bool hasWindows{ false };
+    float kWeightedMeanEnergy{ 0.0f };
+    std::vector<float> kWeightedWindowEnergies;
+    std::vector<float> windowRMS;
+
+    bool exactPercentiles{ false };
+
+    bool hasDeltaHistogram{ false };
+    QuantileHistogram deltaHistogram = QuantileHistogram::forSampleDeltas();
+
+    bool hasDeltaPercentile{ false };
+    float deltaPercentileRank{ 0.0f };
+    float deltaPercentile{ 0.0f };
+};
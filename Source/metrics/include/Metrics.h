@@ -5,6 +5,8 @@
  * - Calculates essential audio metrics including RMSE, correlation, crest factor, and gain reduction.
  * - Computes advanced metrics such as Loudness Range (LRA) using EBU R128 standards.
  * - Supports both RMS and Peak-based compression analysis.
+ * - The metric families of all signals run as a task graph on a thread pool, with a per-task
+ *   timing breakdown.
  *
  * License:
  * This file is part of the PeakRMSCompressorWorkbench project.
@@ -26,6 +28,8 @@
 #pragma once
 
 #include <juce_audio_basics/juce_audio_basics.h>
+#include "DerivedSignal.h"
+#include "TaskGraph.h"
 #include <cmath>
 #include <string>
 
@@ -44,7 +48,7 @@ public:
         juce::AudioBuffer<float>* signal = nullptr;
         juce::AudioBuffer<float>* GRSignal = nullptr;
         
-        char* signalName{ };
+        const char* signalName{ };
         bool isCompressed{ false };
 
         // Signal metrics
@@ -107,6 +111,17 @@ public:
         }
     };
 
+    // Gain reduction statistics of a single GR signal, same definitions as in CompressionMetrics
+    struct GainReductionStatistics
+    {
+        float avgGR{ 0.0f };
+        float maxGR{ 0.0f };
+        float stdDevGR{ 0.0f };
+        float energyGR{ 0.0f };
+        float rateOfChangeGR{ 0.0f };
+        float compressionActivityRatio{ 0.0f };
+    };
+
     //==============================================================================
     const CompressionMetrics& getUncompressedMetrics() const;
     const CompressionMetrics& getPeakMetrics() const;
@@ -115,6 +130,16 @@ public:
     //==============================================================================
     void prepare(const double& fs);
 
+    // Length and hop of the windows of the short-term statistics (LRA, transient energy preservation)
+    void setWindowing(float windowSeconds, float hopSeconds);
+
+    // Threads of extractMetrics (0 => one per CPU core, 1 => serial on the calling thread)
+    void setNumThreads(int numThreads);
+
+    // LRA and transient impact from sorting all values instead of fixed-memory histograms
+    // (QuantileHistogram, loudness error < 0.016 dB, sample delta error < 0.19%)
+    void setExactPercentiles(bool shouldBeExact);
+
     //==============================================================================
     void setUncompressedSignal(juce::AudioBuffer<float>* signal);
     
@@ -130,27 +155,23 @@ public:
     //==============================================================================
     void extractMetrics();
 
-private:
-    //==============================================================================
-    
-    // Signal metrics
-    //==============================================================================
-    /**
-     * Computes the peak value of the given audio buffer.
-     *
-     * @param buffer The input audio buffer.
-     * @return The peak value in linear scale.
-     */
-    float getPeakValue(const juce::AudioBuffer<float>& buffer);
+    // Start and duration of every task of the last extractMetrics call
+    juce::String formatTaskTimings() const;
 
     /**
-     * Calculates the average energy of the audio buffer.
+     * Computes the gain reduction statistics of any gain reduction signal, e.g. for comparing
+     * alternative processing modes against the signals registered above.
      *
-     * @param buffer The input audio buffer.
-     * @return The average energy in linear scale.
+     * @param gainReductionSignal The gain reduction signal in linear gain.
+     * @return The gain reduction statistics.
      */
-    float getAverageEnergy(const juce::AudioBuffer<float>& buffer);
+    GainReductionStatistics getGainReductionStatistics(const juce::AudioBuffer<float>& gainReductionSignal);
 
+private:
+    //==============================================================================
+    
+    // Signal metrics
+    //==============================================================================
     /**
      * Converts a mean square value into RMS.
      *
@@ -172,10 +193,10 @@ private:
      * Computes the Integrated Loudness (LUFS) of the given audio buffer, following
      * the EBU R128 standard.
      *
-     * @param buffer The input audio buffer.
+     * @param signal The derived data of the input signal.
      * @return The LUFS value of the signal.
      */
-    float getLUFS(const juce::AudioBuffer<float>& buffer);
+    float getLUFS(DerivedSignal& signal);
 
     /**
      * Computes the Loudness Range (LRA) of the given audio buffer.
@@ -183,13 +204,11 @@ private:
      * LRA measures the dynamic range of loudness over time, following
      * the EBU R128 standard.
      *
-     * @param buffer The input audio buffer.
-     * @param sampleRate The sampling rate of the audio.
-     * @param windowDuration The duration (in seconds) of each sliding window.
-     * @param hopDuration The hop size (in seconds) between consecutive windows.
-     * @return The Loudness Range (LRA) in LU (Loudness Units).
+     * @param signal The derived data of the input signal (windows of windowDuration every hopDuration).
+     * @return The Loudness Range (LRA) in LU (Loudness Units), from a histogram of the window
+     *         energies unless exactPercentiles is set.
      */
-    float getLRA(const juce::AudioBuffer<float>& buffer);
+    float getLRA(DerivedSignal& signal);
 
     // Metrics for comparing uncompressed and compressed signals
     //==============================================================================
@@ -212,102 +231,46 @@ private:
     /**
      * Calculates the transient impact of compression on the signal.
      *
-     * @param compressedSignal The compressed audio signal buffer.
+     * @param compressedSignal The derived data of the compressed signal.
      * @return The relative change in transient amplitude.
      */
-    float getTransientImpact(const juce::AudioBuffer<float>& compressedSignal);
+    float getTransientImpact(DerivedSignal& compressedSignal);
 
     /**
      * Measures how much transient energy is preserved after compression.
      *
-     * @param compressedSignal The compressed audio signal buffer.
+     * @param compressedSignal The derived data of the compressed signal.
      * @return The transient energy preservation ratio (0 to 1).
      */
-    float getTransientEnergyPreservation(const juce::AudioBuffer<float>& compressedSignal);
+    float getTransientEnergyPreservation(DerivedSignal& compressedSignal);
 
-    /**
-     * Computes the harmonic distortion introduced by compression.
-     *
-     * @param compressedBuffer The compressed audio signal buffer.
-     * @return The harmonic distortion in dB.
-     */
-    float getWaveformDistortion(const juce::AudioBuffer<float>& compressedBuffer);
-
-    // Gain reduction signal metrics
-    //==============================================================================
-    /**
-     * Finds the maximum gain reduction applied during compression.
-     *
-     * @param gainReductionBuffer The buffer representing the gain reduction signal.
-     * @return The maximum gain reduction in dB.
-     */
-    float getMaxGainReduction(const juce::AudioBuffer<float>& gainReductionBuffer) const;
-
-    /**
-     * Computes the average gain reduction applied during compression.
-     *
-     * @param gainReductionBuffer The buffer representing the gain reduction signal.
-     * @return The average gain reduction in dB.
-     */
-    float getAverageGainReduction(const juce::AudioBuffer<float>& gainReductionBuffer) const;
-
-    /**
-     * Computes the standard deviation of the gain reduction signal.
-     *
-     * @param gainReductionBuffer The buffer representing the gain reduction signal.
-     * @param mean The mean value of gain reduction.
-     * @return The standard deviation of the gain reduction in dB.
-     */
-    float getStdDevGainReduction(const juce::AudioBuffer<float>& gainReductionBuffer, float mean);
-
-    /**
-     * Measures the total energy reduction due to compression.
-     *
-     * @param gainReductionBuffer The buffer representing the gain reduction signal.
-     * @return The gain reduction energy in dB.
-     */
-    float getEnergyGainReduction(const juce::AudioBuffer<float>& gainReductionBuffer);
-
-    /**
-     * Calculates the rate of change in the gain reduction signal.
-     *
-     * @param gainReductionSignal The buffer representing the gain reduction signal.
-     * @return The average rate of change of gain reduction.
-     */
-    float getRateOfChangeGainReduction(const juce::AudioBuffer<float>& gainReductionSignal);
-
-    /**
-     * Computes the ratio of time the compressor is actively reducing gain.
-     *
-     * @param gainReductionSignal The buffer representing the gain reduction signal.
-     * @return The compression activity ratio (0 to 1).
-     */
-    float getCompressionActivityRatio(const juce::AudioBuffer<float>& gainReductionSignal);
-
-    
-    
     //==============================================================================
     bool validateSignals() const;
-   
-    void applyKWeighting(juce::AudioBuffer<float>& buffer);
-
-    std::vector<juce::AudioBuffer<float>> getWindowsFromBuffer(const juce::AudioBuffer<float>& buffer);
 
     //==============================================================================
 
     float getIntegratedLoudness(float meanSquare);
 
-    std::vector<float> getShortTermLoudness(juce::AudioBuffer<float>& buffer);
+    std::vector<float> getShortTermLoudness(DerivedSignal& signal);
     
     //==============================================================================
     float transientPercentile = 0.5f;
     double sampleRate{ 0.0f };
+    int numThreads{ 0 };
+    bool exactPercentiles{ false };
 
     // for extracting windows for short-term calculations
-    float windowDuration{ 0.4f }; // 40 ms windows
-    float hopDuration{ 0.2f }; // 20 ms overlaps
+    float windowDuration{ 0.4f }; // 400 ms windows
+    float hopDuration{ 0.2f }; // 200 ms hop
 
     CompressionMetrics uncompressedMetrics;
     CompressionMetrics peakMetrics;
     CompressionMetrics rmsMetrics;
+
+    // K-weighting, windows and transient statistics of the signals above
+    DerivedSignal uncompressedDerived;
+    DerivedSignal peakDerived;
+    DerivedSignal rmsDerived;
+
+    TaskGraph taskGraph;
 };
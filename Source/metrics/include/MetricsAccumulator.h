@@ -0,0 +1,101 @@
+/*
+ * This file defines MetricsAccumulator, which gathers every sample domain statistic of a signal
+ * in one pass: level (silence gated energy, peak), waveform distortion against its reference
+ * and the gain reduction statistics of its GR signal.
+ *
+ * Key Features:
+ * - One pass over the signal, its reference and its GR signal instead of one pass per metric.
+ *   The loops run over 8 independent lanes so the compiler vectorizes the reductions, gains are
+ *   converted to dB with the SIMD kernel FastMath::gainToDecibels.
+ * - Partial sums are kept in float per block and in double across blocks.
+ * - Chunks can be accumulated one after another (streaming), or by separate accumulators that
+ *   are merged in time order afterwards (e.g. one per thread).
+ * - Same definitions as the former per-metric functions of Metrics, including the mean in dB
+ *   being subtracted from the linear gain in the GR standard deviation.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Metrics.h"
+#include <vector>
+
+class MetricsAccumulator
+{
+public:
+    //==============================================================================
+    void prepare(int numChannels);
+
+    /*
+    * Accumulates samples [startSample, startSample + numSamples) of every channel. Any of the
+    * buffers may be nullptr, the reference is only used together with the signal.
+    *
+    * @param signal         The signal (level statistics).
+    * @param reference      The uncompressed signal the signal is compared with (distortion).
+    * @param gainReduction  The gain reduction signal of the signal, in linear gain.
+    */
+    void process(const juce::AudioBuffer<float>* signal,
+        const juce::AudioBuffer<float>* reference,
+        const juce::AudioBuffer<float>* gainReduction,
+        int startSample,
+        int numSamples);
+
+    // Adds an accumulator that processed the samples right after the ones of this accumulator
+    void merge(const MetricsAccumulator& following);
+
+    //==============================================================================
+    juce::int64 getNumSamples() const { return numFrames; }
+
+    float getMeanEnergy() const;            // silence gated, linear
+    float getPeak() const { return peak; }  // linear
+    float getWaveformDistortion() const;    // error RMS / reference RMS
+    Metrics::GainReductionStatistics getGainReductionStatistics(double sampleRate) const;
+
+private:
+    //==============================================================================
+    void processSignal(const float* x, const float* reference, int numSamples);
+    void processGainReduction(const float* gain, float previousGain, bool hasPreviousGain, int numSamples);
+
+    static constexpr int numLanes = 8;
+    static constexpr int blockSize = 1024;
+    static constexpr float silenceThreshold = 0.0001f;
+    static constexpr float silentGain = 1.0e-5f;   // -100 dB, ignored by the dB statistics
+
+    int numChannels{ 0 };
+    juce::int64 numFrames{ 0 };
+
+    // Signal
+    double energy{ 0.0 };
+    float peak{ 0.0f };
+    double referenceEnergy{ 0.0 }, errorEnergy{ 0.0 };
+
+    // Gain reduction
+    double sumAbsDecibels{ 0.0 };
+    float minGain{ 1.0f };          // largest gain reduction, among non-silent gains
+    double sumGain{ 0.0 }, sumGainSquared{ 0.0 };
+    double gatedGainEnergy{ 0.0 };
+    double sumAbsChange{ 0.0 };
+    juce::int64 numActive{ 0 };
+
+    // First and last gain of every channel, for the changes across chunk boundaries
+    std::vector<float> firstGain, lastGain;
+    bool hasGain{ false };
+
+    std::vector<float> decibels;    // per block scratch
+};
@@ -2,9 +2,11 @@
 #include <JuceHeader.h>
 #include "AudioFileLoader.h"
 #include "DataExport.h"
+#include "Metrics.h"
+#include "StreamingMetrics.h"
+#include <functional>
 
 class Compressor;
-class Metrics;
 
 class MetricsExtractionEngine
 {
@@ -12,31 +14,144 @@ public:
     struct Config
     {
         int chunkSize = 1024;
-        int maxDurationMinutes = 20;  // safety cap
+        int maxDurationMinutes = 20;  // safety cap of the in-memory mode (0 => no limit)
+
+        // Windows of the short-term statistics (LRA, transient energy preservation)
+        float windowSeconds = 0.4f;
+        float hopSeconds = 0.2f;
+
+        // In-memory mode: threads of the metrics task graph (0 => one per CPU core, 1 => serial).
+        // The task timings go to the report.
+        int metricsThreads = 0;
+
+        // In-memory mode: LRA and transient impact from sorting all values instead of
+        // fixed-memory histograms (needs 4 bytes per sample and channel for the transient impact)
+        bool exactPercentiles = false;
+
+        // Streaming mode: the file is read, compressed, measured and written chunk by chunk with
+        // fixed memory, so files of any length (also beyond maxDurationMinutes) can be analyzed.
+        // Segment-parallel compression and the control-rate comparison need the whole file and
+        // are skipped in this mode.
+        bool streaming = false;
+
+        // Streaming mode only: decode, peak / rms compression, metrics and WAV writing run on their
+        // own threads, with up to pipelineDepth chunks in flight. Stage utilization goes to the report.
+        bool pipelined = false;
+        int pipelineDepth = 4;
+
+        // Segment-parallel offline compression: the file is split into segments that are
+        // compressed on a thread pool. Each segment is primed with a warm-up run over the
+        // preceding audio so the detector state converges before the segment starts.
+        bool parallelCompression = false;
+        int numSegments = 0;               // 0 => one segment per CPU core
+        float warmUpTimeConstants = 10.0f; // warm-up length in multiples of max(attack, release)
+        bool verifyParallelCompression = false; // also run serially and report the max deviation
+
+        // Control-rate comparison: if > 1, the file is also compressed with the gain evaluated
+        // every controlRateComparison samples (4, 8, 16 or 32), and the report compares its gain
+        // reduction with the full-rate result
+        int controlRateComparison = 0;
+    };
+
+    // Result of the segment-parallel compression for one detector type
+    struct ParallelCompressionReport
+    {
+        bool used = false;
+        int numSegments = 0;
+        int warmUpSamples = 0;
+        bool verified = false;
+        float maxSignalDeviation = 0.0f; // max |parallel - serial| of the compressed signal (linear)
+        float maxGainReductionDeviation = 0.0f; // max |parallel - serial| of the GR signal (linear)
+    };
+
+    // Control-rate gain reduction compared with the full-rate gain reduction for one detector type
+    struct ControlRateReport
+    {
+        bool used = false;
+        int controlInterval = 0;
+        Metrics::GainReductionStatistics fullRate;
+        Metrics::GainReductionStatistics controlRate;
+        float maxDeviationDb = 0.0f;  // max |control rate - full rate| of the GR signal in dB
+        float meanDeviationDb = 0.0f; // mean |control rate - full rate| of the GR signal in dB
     };
 
+    // Value of a parameter by its id ("peak_threshold", "rms_ratio", "lookahead", ...) for the report,
+    // e.g. read from the plugin's AudioProcessorValueTreeState or from command line arguments
+    using ParameterSource = std::function<float(const juce::String& parameterID)>;
+
     MetricsExtractionEngine(AudioFileLoader& loader,
         DataExport& exporter,
         Compressor& peakCompressor,
         Compressor& rmsCompressor,
         Metrics& metrics,
-        juce::AudioProcessorValueTreeState& apvts,
+        ParameterSource parameterSource,
         Config cfg);
 
-    void run(const juce::File& selectedFile);
+    // Load -> compress -> metrics -> export; returns false (and the reason in error) if a stage failed
+    bool run(const juce::File& selectedFile, juce::String* error = nullptr);
 
     bool isProcessing() const noexcept { return processing.load(); }
     double getProgress() const noexcept { return progress.load(); }
 
 private:
+    // Both throw std::runtime_error if a stage fails
+    // Load -> compress -> metrics -> export with the whole file in memory
+    void runInMemory();
+    // Read -> compress -> metrics -> write chunk by chunk
+    void runStreaming();
+
+    // One chunk of the streaming mode, aligned: all buffers start at the same file sample
+    struct StreamingChunk
+    {
+        juce::AudioBuffer<float> reference;     // uncompressed input delayed by the latency
+        juce::AudioBuffer<float> peak, peakGR;
+        juce::AudioBuffer<float> rms, rmsGR;
+        int numSamples = 0;
+        int outputStart = 0;                    // [outputStart, outputEnd) belongs to the file
+        int outputEnd = 0;
+    };
+
     void compressAudioFile();
     void processBufferInChunks(juce::AudioBuffer<float>& grBuffer,
         juce::AudioBuffer<float>& audioBuffer,
         bool isRMS,
         Compressor& compressor);
 
+    void processBufferInSegments(juce::AudioBuffer<float>& grBuffer,
+        juce::AudioBuffer<float>& audioBuffer,
+        bool isRMS,
+        Compressor& compressor,
+        ParallelCompressionReport& report);
+
+    // Compresses source[start, end) chunk by chunk; output and GR are written to the same range
+    // of the destination buffers unless they are nullptr (warm-up). A compressor latency
+    // (lookahead) is compensated by running the input latency samples further.
+    void compressRange(Compressor& compressor,
+        bool isRMS,
+        const juce::AudioBuffer<float>& source,
+        juce::AudioBuffer<float>* destination,
+        juce::AudioBuffer<float>* grDestination,
+        juce::AudioBuffer<float>& chunkBuffer,
+        int start,
+        int end,
+        int latency) const;
+
+    // Compresses the loaded file at control rate into controlRateGainReduction
+    void compressAtControlRate(juce::AudioBuffer<float>& controlRateGainReduction,
+        bool isRMS,
+        Compressor& compressor);
+
+    ControlRateReport compareControlRate(const juce::AudioBuffer<float>& fullRateGainReduction,
+        const juce::AudioBuffer<float>& controlRateGainReduction);
+
+    int getWarmUpSamples(Compressor& compressor) const;
+    juce::String formatParallelReport(const juce::String& title, const ParallelCompressionReport& report) const;
+    juce::String formatControlRateReport(const juce::String& title, const ControlRateReport& report) const;
+
     void getMetrics();
-    juce::String buildMetricsReport() const;
+    juce::String buildMetricsReport(const Metrics::CompressionMetrics& uncompressed,
+        const Metrics::CompressionMetrics& peak,
+        const Metrics::CompressionMetrics& rms) const;
 
     float getParam(const juce::String& id) const;
     juce::String formatParameterBlock(const juce::String& title,
@@ -49,7 +164,7 @@ private:
     Compressor& peakCompressor;
     Compressor& rmsCompressor;
     Metrics& metrics;
-    juce::AudioProcessorValueTreeState& apvts;
+    ParameterSource parameterSource;
     Config cfg;
 
     // State
@@ -64,6 +179,16 @@ private:
     juce::AudioBuffer<float> rmsCompressedSignal;
     juce::AudioBuffer<float> rmsGainReductionSignal;
 
+    ParallelCompressionReport peakParallelReport;
+    ParallelCompressionReport rmsParallelReport;
+
+    juce::AudioBuffer<float> peakControlRateGainReduction;
+    juce::AudioBuffer<float> rmsControlRateGainReduction;
+    ControlRateReport peakControlRateReport;
+    ControlRateReport rmsControlRateReport;
+
+    StreamingMetrics streamingMetrics;
+
     // UI/progress
     std::atomic<bool> processing{ false };
     std::atomic<double> progress{ 0.0 };
@@ -0,0 +1,75 @@
+/*
+ * This file defines QuantileHistogram, the fixed-memory percentile estimator of Metrics and
+ * StreamingMetrics (loudness range, transient impact).
+ *
+ * Key Features:
+ * - Log-spaced bins over [minValue, maxValue): values are counted, never stored, so memory is
+ *   fixed (numBins counters) whatever the number of values.
+ * - Ranks are exact; the value at a rank is the geometric center of its bin, so the relative
+ *   error is bounded by half a bin (getMaxRelativeError()).
+ * - Mergeable: histograms with the same layout filled from different chunks, channels or threads
+ *   add up to the histogram of all values.
+ * - Bin 0 holds everything below minValue (reported as 0), the last bin everything from maxValue
+ *   on (reported as maxValue).
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+class QuantileHistogram
+{
+public:
+    //==============================================================================
+    QuantileHistogram(float minValue, float maxValue, int numBins);
+
+    // |x[n] - x[n-1]| of full scale audio: 1e-6 .. 4, relative error < 0.19%
+    static QuantileHistogram forSampleDeltas();
+
+    // Mean window energies: 1e-5 (-100 dB, where the loudness is clamped anyway) .. 16,
+    // loudness error < 0.016 dB
+    static QuantileHistogram forWindowEnergies();
+
+    //==============================================================================
+    void reset();
+    void add(float value);
+    void add(const float* values, int numValues);
+
+    // Both histograms need the same layout
+    void merge(const QuantileHistogram& other);
+
+    //==============================================================================
+    juce::uint64 getCount() const { return count; }
+
+    // Value at the given rank (0..count-1) in sorted order
+    float getValueAtRank(juce::uint64 rank) const;
+
+    // Largest relative deviation of getValueAtRank() from the exact value between the outer bins
+    float getMaxRelativeError() const;
+
+private:
+    //==============================================================================
+    float minValue, maxValue;
+    int numBins;
+    float binsPerOctave;
+
+    std::vector<juce::uint64> bins;
+    juce::uint64 count{ 0 };
+};
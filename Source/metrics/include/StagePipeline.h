@@ -0,0 +1,97 @@
+/*
+ * This file defines StagePipeline, which runs the stages of the streaming extraction
+ * (decode, peak / rms compression, metrics, WAV writing) on their own threads.
+ *
+ * Key Features:
+ * - Chunks live in a fixed number of slots (chunk i uses slot i % numSlots), so memory is
+ *   bounded by numSlots chunks.
+ * - Every stage publishes the number of chunks it has finished in an atomic counter. A stage
+ *   takes chunk i once all its dependencies have finished it; the first stage only reuses a
+ *   slot once every stage has finished the chunk in it (backpressure). No locks are taken on
+ *   this path, idle stages sleep on an event.
+ * - Busy and waiting time of every stage, for utilization statistics.
+ * - runSerially() runs the same stages one chunk at a time on the calling thread.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class StagePipeline
+{
+public:
+    // Processes chunk chunkIndex in slot slot; returns false (and sets error) to abort the pipeline
+    using StageFunction = std::function<bool(int slot, juce::int64 chunkIndex, juce::String& error)>;
+
+    struct StageStatistics
+    {
+        juce::String name;
+        juce::int64 numChunks{ 0 };
+        double busySeconds{ 0.0 };
+        double waitingSeconds{ 0.0 };   // waiting for input or, in the first stage, for a free slot
+        double utilization{ 0.0 };      // busy time / wall time of the run
+    };
+
+    explicit StagePipeline(int numSlots);
+
+    // Stages have to be added in an order that respects their dependencies (indices of earlier stages)
+    int addStage(const juce::String& name, StageFunction function, std::vector<int> dependencies = {});
+
+    int getNumSlots() const { return numSlots; }
+
+    // Both return false if a stage failed, with its error message in error
+    bool run(juce::int64 numChunks, juce::String* error = nullptr);
+    bool runSerially(juce::int64 numChunks, juce::String* error = nullptr);
+
+    const std::vector<StageStatistics>& getStatistics() const { return statistics; }
+    double getWallSeconds() const { return wallSeconds; }
+    juce::String formatStatistics(const juce::String& title) const;
+
+private:
+    struct Stage
+    {
+        juce::String name;
+        StageFunction function;
+        std::vector<int> dependencies;
+        std::atomic<juce::int64> finished{ 0 };
+        juce::WaitableEvent progressed;
+    };
+
+    bool isReady(const Stage& stage, juce::int64 chunkIndex) const;
+    void runStage(int stageIndex, juce::int64 numChunks);
+    void fail(const juce::String& message);
+    void wakeAll();
+
+    void resetStatistics();
+    void finishStatistics(juce::int64 startTicks);
+
+    int numSlots;
+    std::vector<std::unique_ptr<Stage>> stages;
+
+    std::atomic<bool> failed{ false };
+    juce::CriticalSection errorLock;    // only taken when a stage fails
+    juce::String failure;
+
+    std::vector<StageStatistics> statistics;
+    double wallSeconds{ 0.0 };
+};
@@ -0,0 +1,115 @@
+/*
+ * This file defines StreamingMetrics, the chunk by chunk counterpart of Metrics::extractMetrics
+ * used by the streaming mode of MetricsExtractionEngine.
+ *
+ * Key Features:
+ * - Takes aligned chunks of the uncompressed signal and of both compressed signals with their
+ *   gain reduction, so no full-length buffer is ever needed.
+ * - Produces the same CompressionMetrics as Metrics, with the same definitions (silence gating,
+ *   400 ms windows every 200 ms by default, K-weighting, percentiles).
+ * - Memory doesn't depend on the length of the signal, apart from one loudness and two RMS
+ *   values per 200 ms hop (about 1 MB for a 3 hour file).
+ *
+ * Differences to Metrics:
+ * - The percentiles always come from QuantileHistogram, the exact ones of
+ *   Metrics::setExactPercentiles need the whole signal.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Metrics.h"
+#include "MetricsAccumulator.h"
+#include "QuantileHistogram.h"
+#include "WindowedEnergy.h"
+#include <vector>
+
+class StreamingMetrics
+{
+public:
+    //==============================================================================
+    // Same as Metrics::setWindowing, call before prepare()
+    void setWindowing(float windowSeconds, float hopSeconds);
+
+    void prepare(double sampleRate, int numChannels);
+
+    /*
+    * Accumulates samples [startSample, startSample + numSamples) of aligned chunks. All buffers
+    * have (at least) the prepared number of channels.
+    *
+    * @param uncompressed  The uncompressed signal.
+    * @param peak, peakGR  The peak compressed signal and its gain reduction (linear gain).
+    * @param rms, rmsGR    The rms compressed signal and its gain reduction (linear gain).
+    */
+    void process(const juce::AudioBuffer<float>& uncompressed,
+        const juce::AudioBuffer<float>& peak, const juce::AudioBuffer<float>& peakGR,
+        const juce::AudioBuffer<float>& rms, const juce::AudioBuffer<float>& rmsGR,
+        int startSample, int numSamples);
+
+    // Metrics of everything accumulated since prepare()
+    void getMetrics(Metrics::CompressionMetrics& uncompressed,
+        Metrics::CompressionMetrics& peak,
+        Metrics::CompressionMetrics& rms) const;
+
+    juce::int64 getNumSamples() const { return numFrames; }
+
+private:
+    //==============================================================================
+    // Loudness and transient statistics of one signal
+    struct SignalAccumulator
+    {
+        void prepare(double sampleRate, int numChannels, int windowSize, int hopSize);
+        void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+        int numChannels{ 0 };
+
+        std::vector<juce::dsp::IIR::Filter<float>> lowShelf, highShelf;
+        std::vector<float> previousSample;
+        bool hasPreviousSample{ false };
+
+        WindowedEnergy windows;             // for transient energy preservation
+        WindowedEnergy kWeightedWindows;    // for LUFS and LRA
+        QuantileHistogram deltas = QuantileHistogram::forSampleDeltas();   // for transient impact
+
+        juce::AudioBuffer<float> kWeighted; // per chunk scratch
+    };
+
+    //==============================================================================
+    void fillSignalMetrics(const SignalAccumulator& signal, const MetricsAccumulator& totals,
+        Metrics::CompressionMetrics& metrics) const;
+    void fillCompressionMetrics(const SignalAccumulator& signal, const MetricsAccumulator& totals,
+        Metrics::CompressionMetrics& metrics) const;
+
+    static float getLRA(const std::vector<float>& windowEnergies);
+    static float getTransientEnergyPreservation(const std::vector<float>& uncompressedEnergies,
+        const std::vector<float>& compressedEnergies);
+
+    //==============================================================================
+    // Same definitions as in Metrics
+    static constexpr float transientPercentile = 0.5f;
+    float windowDuration{ 0.4f };
+    float hopDuration{ 0.2f };
+
+    double sampleRate{ 0.0 };
+    int numChannels{ 0 };
+    juce::int64 numFrames{ 0 };
+
+    SignalAccumulator uncompressedSignal, peakSignal, rmsSignal;
+    MetricsAccumulator uncompressedTotals, peakTotals, rmsTotals;   // level, distortion and GR statistics
+};
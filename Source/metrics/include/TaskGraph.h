@@ -0,0 +1,88 @@
+/*
+ * This file defines TaskGraph, which runs a small set of dependent tasks on a thread pool
+ * (used by Metrics::extractMetrics for the metric families of every signal).
+ *
+ * Key Features:
+ * - Tasks name the tasks they depend on; a task is queued as soon as its last dependency has
+ *   finished, so independent tasks of different signals overlap freely.
+ * - Deterministic results: every task writes its own outputs and nothing is reduced across
+ *   threads, so the thread count only changes the timing.
+ * - With one thread, tasks run in the order they were added on the calling thread.
+ * - Start and duration of every task, for a timing breakdown of the run.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class TaskGraph
+{
+public:
+    using TaskFunction = std::function<void()>;
+
+    struct TaskTiming
+    {
+        juce::String name;
+        double startSeconds{ 0.0 };     // since the start of the run
+        double busySeconds{ 0.0 };
+    };
+
+    //==============================================================================
+    void clear();
+
+    // Dependencies are indices of earlier tasks, so the graph can't have cycles
+    int addTask(const juce::String& name, TaskFunction function, std::vector<int> dependencies = {});
+
+    // numThreads <= 0 => one thread per CPU core
+    void run(int numThreads);
+
+    //==============================================================================
+    const std::vector<TaskTiming>& getTimings() const { return timings; }
+    double getWallSeconds() const { return wallSeconds; }
+    int getNumThreads() const { return usedThreads; }
+    juce::String formatTimings(const juce::String& title) const;
+
+private:
+    //==============================================================================
+    struct Task
+    {
+        juce::String name;
+        TaskFunction function;
+        std::vector<int> dependents;
+        int numDependencies{ 0 };
+        std::atomic<int> waitingFor{ 0 };
+    };
+
+    void runTask(int index, juce::int64 startTicks);
+    void enqueueReadyDependents(int index, juce::int64 startTicks);
+
+    std::vector<std::unique_ptr<Task>> tasks;
+
+    juce::ThreadPool* pool = nullptr;       // only during run()
+    std::atomic<int> tasksLeft{ 0 };
+    juce::WaitableEvent allTasksDone;
+
+    std::vector<TaskTiming> timings;
+    double wallSeconds{ 0.0 };
+    int usedThreads{ 0 };
+};
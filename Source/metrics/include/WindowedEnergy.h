@@ -0,0 +1,71 @@
+/*
+ * This file defines WindowedEnergy, the sliding window engine behind the short-term statistics
+ * of Metrics and StreamingMetrics (short-term loudness, transient energy preservation).
+ *
+ * Key Features:
+ * - Mean silence gated energy of every complete window (windowSize long, every hopSize samples),
+ *   without copying a single sample.
+ * - The signal is summed into blocks of gcd(windowSize, hopSize) samples, and every window is
+ *   a running sum over its blocks, so a window costs O(1) whatever the overlap.
+ * - Works on a whole buffer or chunk by chunk; windows spanning chunk borders are no special case.
+ * - Also keeps the gated energy of all samples, including the ones after the last window.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+class WindowedEnergy
+{
+public:
+    //==============================================================================
+    void prepare(int windowSize, int hopSize, int numChannels);
+
+    // Adds samples [startSample, startSample + numSamples) of every channel
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    //==============================================================================
+    // Mean energy (linear) of every complete window so far, in time order
+    const std::vector<float>& getWindowEnergies() const { return windowEnergies; }
+
+    // Gated energy sum of all samples so far, over all channels
+    double getTotalEnergy() const { return totalEnergy + blockEnergy; }
+
+private:
+    //==============================================================================
+    void finishBlock();
+
+    static constexpr float silenceThreshold = 0.0001f;   // same gate as MetricsAccumulator
+
+    int windowSize{ 0 }, hopSize{ 0 }, numChannels{ 0 };
+    int blockSize{ 0 };
+    int blocksPerWindow{ 0 }, blocksPerHop{ 0 };
+
+    int samplesInBlock{ 0 };
+    double blockEnergy{ 0.0 };
+    juce::int64 numBlocks{ 0 };
+
+    // Energies of the last blocksPerWindow blocks and their running sum
+    std::vector<double> recentBlocks;
+    double windowSum{ 0.0 };
+
+    double totalEnergy{ 0.0 };
+    std::vector<float> windowEnergies;
+};
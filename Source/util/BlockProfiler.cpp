@@ -0,0 +1,125 @@
+/*
+ * This file implements BlockProfiler, the timing instrumentation of processBlock.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include/BlockProfiler.h"
+
+BlockProfiler::ScopedStage::ScopedStage(BlockProfiler* p, Stage s) : profiler(p), stage(s)
+{
+    if (profiler != nullptr)
+        start = juce::Time::getHighResolutionTicks();
+}
+
+BlockProfiler::ScopedStage::~ScopedStage()
+{
+    if (profiler != nullptr)
+        profiler->addStageTime(stage, juce::Time::getHighResolutionTicks() - start);
+}
+
+BlockProfiler::BlockProfiler()
+{
+    microsecondsPerTick = 1.0e6 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+}
+
+void BlockProfiler::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    resetRequested = true;
+}
+
+void BlockProfiler::beginBlock()
+{
+    if (resetRequested.exchange(false))
+        statistics = {};
+
+    blockStart = juce::Time::getHighResolutionTicks();
+}
+
+void BlockProfiler::endBlock(int numSamples)
+{
+    const double microseconds = static_cast<double>(juce::Time::getHighResolutionTicks() - blockStart) * microsecondsPerTick;
+    const double deadlineMicroseconds = 1.0e6 * numSamples / sampleRate;
+    const double budgetPercent = deadlineMicroseconds > 0.0 ? 100.0 * microseconds / deadlineMicroseconds : 0.0;
+
+    const int microsecondBin = juce::jmin(numMicrosecondBins - 1, static_cast<int>(microseconds / microsecondBinWidth));
+    const int budgetBin = juce::jmin(numBudgetBins - 1, static_cast<int>(budgetPercent / budgetBinWidth));
+    ++statistics.microsecondHistogram[static_cast<size_t>(microsecondBin)];
+    ++statistics.budgetHistogram[static_cast<size_t>(budgetBin)];
+
+    ++statistics.numBlocks;
+    if (budgetPercent > 50.0)  ++statistics.numOver50Percent;
+    if (budgetPercent > 80.0)  ++statistics.numOver80Percent;
+    if (budgetPercent > 100.0) ++statistics.numOver100Percent;
+
+    statistics.totalMicroseconds += microseconds;
+    statistics.maxMicroseconds = juce::jmax(statistics.maxMicroseconds, microseconds);
+    statistics.totalBudgetPercent += budgetPercent;
+    statistics.maxBudgetPercent = juce::jmax(statistics.maxBudgetPercent, budgetPercent);
+
+    snapshot.publish(statistics);
+}
+
+void BlockProfiler::addStageTime(Stage stage, juce::int64 ticks)
+{
+    statistics.stageMicroseconds[static_cast<size_t>(stage)] += static_cast<double>(ticks) * microsecondsPerTick;
+}
+
+const BlockProfiler::Statistics& BlockProfiler::getStatistics()
+{
+    snapshot.pull();
+    return snapshot.current();
+}
+
+void BlockProfiler::reset()
+{
+    resetRequested = true;
+}
+
+juce::String BlockProfiler::Statistics::format() const
+{
+    juce::String text;
+    text << "processBlock timing:\n";
+
+    if (numBlocks == 0)
+        return text << "No blocks processed.\n";
+
+    const double blocks = static_cast<double>(numBlocks);
+    text << "Blocks: " << numBlocks << ", ";
+    text << "Average: " << juce::String(totalMicroseconds / blocks, 1) << " us (" << juce::String(totalBudgetPercent / blocks, 1) << "% of deadline), ";
+    text << "Max: " << juce::String(maxMicroseconds, 1) << " us (" << juce::String(maxBudgetPercent, 1) << "% of deadline).\n";
+    text << "Blocks over 50%: " << numOver50Percent << ", over 80%: " << numOver80Percent << ", over 100%: " << numOver100Percent << ".\n";
+
+    static const char* stageNames[] = { "Metering", "Sidechain", "Detector", "Gain application" };
+    text << "Average per stage:";
+    for (int s = 0; s < numStages; ++s)
+        text << (s == 0 ? " " : ", ") << stageNames[s] << " " << juce::String(stageMicroseconds[static_cast<size_t>(s)] / blocks, 2) << " us";
+    text << ".\n";
+
+    text << "Microseconds per block (bin start: count):\n";
+    for (int b = 0; b < numMicrosecondBins; ++b)
+        if (microsecondHistogram[static_cast<size_t>(b)] > 0)
+            text << "  " << juce::String(b * microsecondBinWidth, 0) << (b == numMicrosecondBins - 1 ? "+" : "") << ": " << static_cast<int>(microsecondHistogram[static_cast<size_t>(b)]) << "\n";
+
+    text << "Percent of deadline (bin start: count):\n";
+    for (int b = 0; b < numBudgetBins; ++b)
+        if (budgetHistogram[static_cast<size_t>(b)] > 0)
+            text << "  " << juce::String(b * budgetBinWidth, 0) << (b == numBudgetBins - 1 ? "+" : "") << "%: " << static_cast<int>(budgetHistogram[static_cast<size_t>(b)]) << "\n";
+
+    return text;
+}
@@ -0,0 +1,112 @@
+/*
+ * This file defines BlockProfiler, the timing instrumentation of processBlock.
+ *
+ * Every block is timestamped with juce::Time::getHighResolutionTicks() and compared with its
+ * deadline (block length / sample rate). The audio thread accumulates:
+ * - A histogram of microseconds per block and a histogram of percent of the deadline.
+ * - The number of blocks over 50%, 80% and 100% of the deadline.
+ * - The time spent in each processing stage (metering, sidechain, detector, gain application).
+ *
+ * After every block the statistics are published through a ParameterSnapshot, so the editor
+ * and DataExport read them without locks.
+ *
+ * License:
+ * This file is part of the PeakRMSCompressorWorkbench project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../../dsp/include/ParameterSnapshot.h"
+#include <array>
+
+class BlockProfiler
+{
+public:
+    /*
+    * Metering:        input/output level followers of the processor.
+    * Sidechain:       channel link and sidechain preparation.
+    * Detector:        level detector and gain computer. The fused, dual-lane and quiet-block
+    *                  paths apply the gain in the same loop, so it is included here for them.
+    * GainApplication: separate gain application passes (reference path, lookahead delay line).
+    */
+    enum Stage { Metering, Sidechain, Detector, GainApplication, numStages };
+
+    static constexpr int numMicrosecondBins = 100;
+    static constexpr double microsecondBinWidth = 10.0;     // the last bin counts everything above
+    static constexpr int numBudgetBins = 41;
+    static constexpr double budgetBinWidth = 5.0;           // percent, the last bin counts >= 200%
+
+    struct Statistics
+    {
+        std::array<juce::uint32, numMicrosecondBins> microsecondHistogram{};
+        std::array<juce::uint32, numBudgetBins> budgetHistogram{};
+        std::array<double, numStages> stageMicroseconds{};
+
+        juce::int64 numBlocks{ 0 };
+        juce::int64 numOver50Percent{ 0 };
+        juce::int64 numOver80Percent{ 0 };
+        juce::int64 numOver100Percent{ 0 };
+
+        double totalMicroseconds{ 0.0 };
+        double maxMicroseconds{ 0.0 };
+        double totalBudgetPercent{ 0.0 };
+        double maxBudgetPercent{ 0.0 };
+
+        // Human readable summary with both histograms, used by the editor and DataExport
+        juce::String format() const;
+    };
+
+    // Times one stage for as long as it exists; does nothing for a nullptr profiler
+    class ScopedStage
+    {
+    public:
+        ScopedStage(BlockProfiler* profiler, Stage stage);
+        ~ScopedStage();
+
+    private:
+        BlockProfiler* profiler;
+        Stage stage;
+        juce::int64 start{ 0 };
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+    };
+
+    BlockProfiler();
+
+    // Sets the sample rate used for the deadline (not on the audio thread while it is running)
+    void prepare(double sampleRate);
+
+    // Audio thread: start and end of a block
+    void beginBlock();
+    void endBlock(int numSamples);
+
+    // Reader thread (one at a time): statistics as published after the last block
+    const Statistics& getStatistics();
+
+    // Any thread: the statistics are cleared at the start of the next block
+    void reset();
+
+private:
+    void addStageTime(Stage stage, juce::int64 ticks);
+
+    double sampleRate{ 44100.0 };
+    double microsecondsPerTick{ 0.0 };
+    juce::int64 blockStart{ 0 };
+
+    Statistics statistics;
+    ParameterSnapshot<Statistics> snapshot;
+    std::atomic<bool> resetRequested{ false };
+};
@@ -39,4 +39,11 @@ namespace Config
         // Do you wish to also save both peak and rms compressed files?
         constexpr bool save = false;
     }
+
+    namespace decodedAudioCache
+    {
+        // Keep decoded MP3 files in a cache (temp folder) so repeated metrics runs skip the decode
+        constexpr bool enable = false;
+        constexpr long long maxMegabytes = 4096;
+    }
 }
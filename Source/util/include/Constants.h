@@ -74,5 +74,9 @@ namespace Constants
         constexpr float makeupStart = -40.0f;
         constexpr float makeupEnd = 40.0f;
         constexpr float makeupInterval = 0.05f;
+
+        constexpr float lookaheadStart = 0.0f;
+        constexpr float lookaheadEnd = 10.0f;
+        constexpr float lookaheadInterval = 0.1f;
     }
 }